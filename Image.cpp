@@ -2,6 +2,41 @@
 #include <algorithm>// std::min
 #include <iostream>// pour operator<< (optionnel)
 #include <fstream>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <atomic>
+
+// Noyaux SSSE3 compilés avec GCC/Clang sur x86 et choisis à l'exécution : pas d'option
+// de compilation supplémentaire, repli scalaire sur les autres plateformes
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IMAGE_SSSE3
+#include <tmmintrin.h>
+#define SSSE3_FN __attribute__((target("ssse3")))
+#endif
+
+// Découpe [begin, end) en tranches contiguës traitées chacune par un thread
+template <typename F>
+static void parallelFor(int begin, int end, F fn, int minChunk = 16)
+{
+    int n = end - begin;
+    if (n <= 0) return;
+
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    int nThreads = std::max(1, std::min(hw > 0 ? hw : 1, n / std::max(1, minChunk)));
+    if (nThreads == 1) {
+        fn(begin, end);
+        return;
+    }
+
+    int chunk = (n + nThreads - 1) / nThreads;
+    std::vector<std::thread> threads;
+    for (int lo = begin + chunk; lo < end; lo += chunk)
+        threads.emplace_back(fn, lo, std::min(end, lo + chunk));
+    fn(begin, std::min(end, begin + chunk));
+    for (std::thread& t : threads) t.join();
+}
 
 void Image::checkSameFormat(const Image& other) const
 {
@@ -9,22 +44,35 @@ void Image::checkSameFormat(const Image& other) const
         throw std::invalid_argument("Images have different format (channels/model)");
 }
 
+void Image::reshape(int w, int h, int ch, const std::string& m)
+{
+    width = w;
+    height = h;
+    channels = ch;
+    model = m;
+    pixels.resize(static_cast<size_t>(w) * h * ch);
+    markAllDirty();
+}
+
 Image::Image(int w, int h, int ch, const std::string& model)
-    : width(w), height(h), channels(ch), model(model), pixels()
+    : width(w), height(h), channels(ch), model(model), pixels(),
+      dirtyTileSize(0), dirtyTilesX(0), dirtyTiles(), cleanFile()
 {
     if (w < 0 || h < 0 || ch < 0) throw std::invalid_argument("Negative dimension");
     pixels.resize(static_cast<size_t>(w) * h * ch);
 }
 
 Image::Image(int w, int h, int ch, const std::string& model, unsigned char fillValue)
-    : width(w), height(h), channels(ch), model(model), pixels()
+    : width(w), height(h), channels(ch), model(model), pixels(),
+      dirtyTileSize(0), dirtyTilesX(0), dirtyTiles(), cleanFile()
 {
     if (w < 0 || h < 0 || ch < 0) throw std::invalid_argument("Negative dimension");
     pixels.assign(static_cast<size_t>(w) * h * ch, fillValue);
 }
 
 Image::Image(int w, int h, int ch, const std::string& model, const std::vector<unsigned char>& buffer)
-    : width(w), height(h), channels(ch), model(model), pixels()
+    : width(w), height(h), channels(ch), model(model), pixels(),
+      dirtyTileSize(0), dirtyTilesX(0), dirtyTiles(), cleanFile()
 {
     if (w < 0 || h < 0 || ch < 0) throw std::invalid_argument("Negative dimension");
     size_t expected = static_cast<size_t>(w) * h * ch;
@@ -33,7 +81,8 @@ Image::Image(int w, int h, int ch, const std::string& model, const std::vector<u
 }
 
 Image::Image(const Image& other)
-    : width(other.width), height(other.height), channels(other.channels), model(other.model), pixels(other.pixels)
+    : width(other.width), height(other.height), channels(other.channels), model(other.model), pixels(other.pixels),
+      dirtyTileSize(0), dirtyTilesX(0)// Une copie n'est pas suivie : ses tuiles propres ne correspondent à aucun fichier
 {
 }
 
@@ -45,9 +94,50 @@ Image& Image::operator=(const Image& other)
     channels = other.channels;
     model = other.model;
     pixels = other.pixels;
+    markAllDirty();// Le suivi reste celui de cette image
+    return *this;
+}
+
+Image::Image(Image&& other) noexcept
+    : Image()
+{
+    swap(other);
+}
+
+Image& Image::operator=(Image&& other)
+{
+    if (this != &other) {
+        Image tmp(std::move(other));
+        if (dirtyTileSize) {
+            // Le suivi reste celui de cette image, tout marqué. Grille préparée dans tmp avant de
+            // toucher à *this : si son allocation échoue, l'image reste intacte
+            tmp.dirtyTileSize = dirtyTileSize;
+            tmp.resetDirtyGrid(1);
+            dirtyTilesX = tmp.dirtyTilesX;
+            dirtyTiles.swap(tmp.dirtyTiles);
+        }
+        width = tmp.width;
+        height = tmp.height;
+        channels = tmp.channels;
+        model.swap(tmp.model);
+        pixels.swap(tmp.pixels);
+    }
     return *this;
 }
 
+void Image::swap(Image& other) noexcept
+{
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+    std::swap(channels, other.channels);
+    model.swap(other.model);
+    pixels.swap(other.pixels);
+    std::swap(dirtyTileSize, other.dirtyTileSize);
+    std::swap(dirtyTilesX, other.dirtyTilesX);
+    dirtyTiles.swap(other.dirtyTiles);
+    cleanFile.swap(other.cleanFile);
+}
+
 Image::~Image() {}
 
 unsigned char& Image::at(int x, int y, int c)
@@ -55,6 +145,7 @@ unsigned char& Image::at(int x, int y, int c)
     if (!inBounds(x, y, c)) {
         throw std::out_of_range("Coordinates out of range");
     }
+    markDirtyPixel(x, y);
     return pixels[getIndex(x, y, c)];
 }
 
@@ -89,6 +180,7 @@ void Image::resize(int newWidth, int newHeight)
     width = newWidth;
     height = newHeight;
     pixels.swap(newPixels);
+    markAllDirty();
 }
 
 void Image::setWidth(int w)
@@ -107,6 +199,7 @@ void Image::setChannels(int ch)
     channels = ch;
     pixels.clear();
     pixels.resize(static_cast<size_t>(width) * height * channels);
+    markAllDirty();
 }
 
 void Image::load(const std::string& filepath)
@@ -128,6 +221,7 @@ void Image::load(const std::string& filepath)
 
     if (!in) throw std::runtime_error("Error while reading header");
 
+    cleanFile.clear();// rétabli une fois la lecture réussie
     width = w;
     height = h;
     channels = ch;
@@ -135,15 +229,20 @@ void Image::load(const std::string& filepath)
 
     size_t total = static_cast<size_t>(width) * height * channels;
     pixels.resize(total);
+    markAllDirty();// grille aux nouvelles dimensions même si la lecture échoue
     in.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(total));
 
     if (!in) throw std::runtime_error("Error while reading pixel data");
+
+    if (dirtyTileSize) resetDirtyGrid(0);// Image identique au fichier
+    cleanFile = filepath;
 }
 
 void Image::save(const std::string& filepath) const
 {
     std::ofstream out(filepath, std::ios::binary);
     if (!out) throw std::runtime_error("Cannot open file for writing");
+    if (filepath == cleanFile) cleanFile.clear();// fichier tronqué : plus une référence tant que l'écriture n'a pas réussi
 
     out.write(reinterpret_cast<const char*>(&width), sizeof(int));
     out.write(reinterpret_cast<const char*>(&height), sizeof(int));
@@ -158,7 +257,12 @@ void Image::save(const std::string& filepath) const
                   static_cast<std::streamsize>(pixels.size()));
     }
 
+    out.close();// vide le tampon : les erreurs d'écriture sont vues avant de faire du fichier la référence
     if (!out) throw std::runtime_error("Error while writing file");
+
+    // Le fichier est maintenant la référence du suivi
+    std::fill(dirtyTiles.begin(), dirtyTiles.end(), 0);
+    cleanFile = filepath;
 }
 
 
@@ -168,11 +272,24 @@ static void computeMaxSize(const Image& a, const Image& b, int& outW, int& outH)
     outH = std::max(a.getHeight(), b.getHeight());
 }
 
-static unsigned char getOrZero(const Image& img, int x, int y, int c)
+// Combine deux images sur la taille max, ligne par ligne ; échantillons hors image = 0
+template <typename Op>
+static void combineRows(const Image& a, const Image& b, Image& result, Op op)
 {
-    if (img.inBounds(x, y, c))
-        return img.getPixel(x, y, c);// pixel valide
-    return 0;// hors limites -> 0
+    size_t n = result.stride();
+    for (int y = 0; y < result.getHeight(); ++y) {
+        const unsigned char* pa = (y < a.getHeight()) ? a.row(y).data() : nullptr;
+        const unsigned char* pb = (y < b.getHeight()) ? b.row(y).data() : nullptr;
+        size_t na = pa ? a.stride() : 0;
+        size_t nb = pb ? b.stride() : 0;
+        unsigned char* out = result.row(y).data();
+
+        size_t i = 0;
+        for (; i < std::min(na, nb); ++i) out[i] = op(pa[i], pb[i]);
+        for (; i < na; ++i) out[i] = op(pa[i], 0);
+        for (; i < nb; ++i) out[i] = op(0, pb[i]);
+        for (; i < n; ++i) out[i] = op(0, 0);
+    }
 }
 
 Image Image::operator+(const Image& other) const
@@ -182,15 +299,7 @@ Image Image::operator+(const Image& other) const
     computeMaxSize(*this, other, newW, newH);
 
     Image result(newW, newH, channels, model, 0);
-
-    for (int y = 0; y < newH; ++y) {
-        for (int x = 0; x < newW; ++x) {
-            for (int c = 0; c < channels; ++c) {
-                int sum = getOrZero(*this, x, y, c) + getOrZero(other, x, y, c);
-                result(x, y, c) = clampToByte(sum);
-            }
-        }
-    }
+    combineRows(*this, other, result, [](int a, int b) { return clampToByte(a + b); });
     return result;
 }
 
@@ -201,22 +310,26 @@ Image& Image::operator+=(const Image& other)
 }
 
 Image Image::operator-(const Image& other) const
+{
+    Image result;
+    subtract(other, result);
+    return result;
+}
+
+void Image::subtract(const Image& other, Image& dst) const
 {
     checkSameFormat(other);
+    if (&dst == this || &dst == &other) {
+        Image tmp;
+        subtract(other, tmp);
+        dst = std::move(tmp);
+        return;
+    }
+
     int newW, newH;
     computeMaxSize(*this, other, newW, newH);
-
-    Image result(newW, newH, channels, model, 0);
-
-    for (int y = 0; y < newH; ++y) {
-        for (int x = 0; x < newW; ++x) {
-            for (int c = 0; c < channels; ++c) {
-                int diff = getOrZero(*this, x, y, c) - getOrZero(other, x, y, c);
-                result(x, y, c) = clampToByte(diff);
-            }
-        }
-    }
-    return result;
+    dst.reshape(newW, newH, channels, model);// combineRows écrit chaque échantillon
+    combineRows(*this, other, dst, [](int a, int b) { return clampToByte(a - b); });
 }
 
 Image& Image::operator-=(const Image& other)
@@ -233,17 +346,7 @@ Image Image::operator^(const Image& other) const
     computeMaxSize(*this, other, newW, newH);
 
     Image result(newW, newH, channels, model, 0);
-
-    for (int y = 0; y < newH; ++y) {
-        for (int x = 0; x < newW; ++x) {
-            for (int c = 0; c < channels; ++c) {
-                int a = getOrZero(*this, x, y, c);
-                int b = getOrZero(other, x, y, c);
-                int d = std::abs(a - b);
-                result(x, y, c) = clampToByte(d);
-            }
-        }
-    }
+    combineRows(*this, other, result, [](int a, int b) { return clampToByte(std::abs(a - b)); });
     return result;
 }
 
@@ -264,6 +367,7 @@ Image Image::operator+(int value) const
 
 Image& Image::operator+=(int value)
 {
+    markAllDirty();
     for (size_t i = 0; i < pixels.size(); ++i) {
         pixels[i] = clampToByte(static_cast<int>(pixels[i]) + value);
     }
@@ -281,6 +385,7 @@ Image Image::operator-(int value) const
 
 Image& Image::operator-=(int value)
 {
+    markAllDirty();
     for (size_t i = 0; i < pixels.size(); ++i) {
         pixels[i] = clampToByte(static_cast<int>(pixels[i]) - value);
     }
@@ -299,6 +404,7 @@ Image Image::operator^(int value) const
 
 Image& Image::operator^=(int value)
 {
+    markAllDirty();
     for (size_t i = 0; i < pixels.size(); ++i) {
         int d = std::abs(static_cast<int>(pixels[i]) - value);
         pixels[i] = clampToByte(d);
@@ -314,16 +420,8 @@ static void checkPixelSize(const Image& img, const std::vector<unsigned char>& p
 
 Image Image::operator+(const std::vector<unsigned char>& pix) const
 {
-    checkPixelSize(*this, pix);
     Image result(*this);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            for (int c = 0; c < channels; ++c) {
-                int sum = at(x, y, c) + pix[c];
-                result(x, y, c) = clampToByte(sum);
-            }
-        }
-    }
+    result += pix;
     return result;
 }
 
@@ -331,11 +429,10 @@ Image& Image::operator+=(const std::vector<unsigned char>& pix)
 {
     checkPixelSize(*this, pix);
     for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            for (int c = 0; c < channels; ++c) {
-                int sum = at(x, y, c) + pix[c];
-                at(x, y, c) = clampToByte(sum);
-            }
+        unsigned char* p = row(y).data();
+        for (int x = 0; x < width; ++x, p += channels) {
+            for (int c = 0; c < channels; ++c)
+                p[c] = clampToByte(p[c] + pix[c]);
         }
     }
     return *this;
@@ -343,16 +440,8 @@ Image& Image::operator+=(const std::vector<unsigned char>& pix)
 
 Image Image::operator-(const std::vector<unsigned char>& pix) const
 {
-    checkPixelSize(*this, pix);
     Image result(*this);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            for (int c = 0; c < channels; ++c) {
-                int diff = at(x, y, c) - pix[c];
-                result(x, y, c) = clampToByte(diff);
-            }
-        }
-    }
+    result -= pix;
     return result;
 }
 
@@ -360,11 +449,10 @@ Image& Image::operator-=(const std::vector<unsigned char>& pix)
 {
     checkPixelSize(*this, pix);
     for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            for (int c = 0; c < channels; ++c) {
-                int diff = at(x, y, c) - pix[c];
-                at(x, y, c) = clampToByte(diff);
-            }
+        unsigned char* p = row(y).data();
+        for (int x = 0; x < width; ++x, p += channels) {
+            for (int c = 0; c < channels; ++c)
+                p[c] = clampToByte(p[c] - pix[c]);
         }
     }
     return *this;
@@ -372,16 +460,8 @@ Image& Image::operator-=(const std::vector<unsigned char>& pix)
 
 Image Image::operator^(const std::vector<unsigned char>& pix) const
 {
-    checkPixelSize(*this, pix);
     Image result(*this);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            for (int c = 0; c < channels; ++c) {
-                int d = std::abs(at(x, y, c) - pix[c]);
-                result(x, y, c) = clampToByte(d);
-            }
-        }
-    }
+    result ^= pix;
     return result;
 }
 
@@ -389,11 +469,10 @@ Image& Image::operator^=(const std::vector<unsigned char>& pix)
 {
     checkPixelSize(*this, pix);
     for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            for (int c = 0; c < channels; ++c) {
-                int d = std::abs(at(x, y, c) - pix[c]);
-                at(x, y, c) = clampToByte(d);
-            }
+        unsigned char* p = row(y).data();
+        for (int x = 0; x < width; ++x, p += channels) {
+            for (int c = 0; c < channels; ++c)
+                p[c] = clampToByte(std::abs(p[c] - pix[c]));
         }
     }
     return *this;
@@ -401,16 +480,24 @@ Image& Image::operator^=(const std::vector<unsigned char>& pix)
 
 Image Image::operator*(double s) const
 {
-    Image result(*this);
+    Image result;
+    scale(s, result);
+    return result;
+}
+
+void Image::scale(double s, Image& dst) const
+{
+    if (&dst != this) dst.reshape(width, height, channels, model);
+    else dst.markAllDirty();
     for (size_t i = 0; i < pixels.size(); ++i) {
         int v = static_cast<int>(pixels[i] * s);
-        result.pixels[i] = clampToByte(v);
+        dst.pixels[i] = clampToByte(v);
     }
-    return result;
 }
 
 Image& Image::operator*=(double s)
 {
+    markAllDirty();
     for (size_t i = 0; i < pixels.size(); ++i) {
         int v = static_cast<int>(pixels[i] * s);
         pixels[i] = clampToByte(v);
@@ -432,6 +519,7 @@ Image Image::operator/(double s) const
 Image& Image::operator/=(double s)
 {
     if (s == 0.0) throw std::invalid_argument("Division by zero");
+    markAllDirty();
     for (size_t i = 0; i < pixels.size(); ++i) {
         int v = static_cast<int>(pixels[i] / s);
         pixels[i] = clampToByte(v);
@@ -458,93 +546,1468 @@ static unsigned char thresholdPixel(const unsigned char* vals, int ch, int thres
     return ok ? 255 : 0;
 }
 
-Image Image::operator<(int threshold) const
+// Seuillage ligne par ligne : une image GRAY 0/255
+void Image::thresholdTo(int threshold, char op, Image& dst) const
 {
-    Image result(width, height, 1, "GRAY", 0);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            std::vector<unsigned char> tmp(channels);
-            for (int c = 0; c < channels; ++c) tmp[c] = getPixel(x, y, c);
-            result(x, y, 0) = thresholdPixel(tmp.data(), channels, threshold, '<');
-        }
+    if (&dst == this && channels != 1) {
+        Image tmp;
+        thresholdTo(threshold, op, tmp);
+        dst = std::move(tmp);
+        return;
     }
+
+    int w = width, h = height, ch = channels;
+    dst.reshape(w, h, 1, "GRAY");
+    for (int y = 0; y < h; ++y) {
+        const unsigned char* src = pixels.data() + static_cast<size_t>(y) * w * ch;
+        unsigned char* out = dst.pixels.data() + static_cast<size_t>(y) * w;
+        for (int x = 0; x < w; ++x)
+            out[x] = thresholdPixel(src + static_cast<size_t>(x) * ch, ch, threshold, op);
+    }
+}
+
+void Image::threshold(int threshold, Image& dst) const
+{
+    thresholdTo(threshold, '>', dst);
+}
+
+Image Image::operator<(int threshold) const
+{
+    Image result;
+    thresholdTo(threshold, '<', result);
     return result;
 }
 
 Image Image::operator<=(int threshold) const
 {
-    Image result(width, height, 1, "GRAY", 0);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            std::vector<unsigned char> tmp(channels);
-            for (int c = 0; c < channels; ++c) tmp[c] = getPixel(x, y, c);
-            result(x, y, 0) = thresholdPixel(tmp.data(), channels, threshold, 'l');
-        }
-    }
+    Image result;
+    thresholdTo(threshold, 'l', result);
     return result;
 }
 
 Image Image::operator>(int threshold) const
 {
+    Image result;
+    thresholdTo(threshold, '>', result);
+    return result;
+}
+
+Image Image::operator>=(int threshold) const
+{
+    Image result;
+    thresholdTo(threshold, 'g', result);
+    return result;
+}
+
+Image Image::operator==(int threshold) const
+{
+    Image result;
+    thresholdTo(threshold, '=', result);
+    return result;
+}
+
+Image Image::operator!=(int threshold) const
+{
+    Image result;
+    thresholdTo(threshold, 'n', result);
+    return result;
+}
+
+Image Image::operator~() const
+{
+    Image result(*this);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        result.pixels[i] = static_cast<unsigned char>(255 - pixels[i]);
+    }
+    return result;
+}
+
+// Masque binaire compacté : 64 pixels par mot, bit (x & 63) du mot (x >> 6)
+struct BitMask
+{
+    int width;
+    int height;
+    int words;// mots par ligne
+    std::vector<uint64_t> bits;
+
+    BitMask(int w, int h)
+        : width(w), height(h), words((w + 63) / 64), bits(static_cast<size_t>(words) * h, 0)
+    {
+    }
+
+    uint64_t* row(int y) { return bits.data() + static_cast<size_t>(y) * words; }
+    const uint64_t* row(int y) const { return bits.data() + static_cast<size_t>(y) * words; }
+};
+
+// Force les bits au-delà de width (dernier mot) à la valeur neutre
+static void fixTail(uint64_t* row, int words, int width, uint64_t fill)
+{
+    int used = width & 63;
+    if (words == 0 || used == 0) return;
+    uint64_t mask = (uint64_t(1) << used) - 1;
+    row[words - 1] = (row[words - 1] & mask) | (fill & ~mask);
+}
+
+// dst[x] = src[x + s] (bits hors ligne = fill)
+static void shiftBits(const uint64_t* src, uint64_t* dst, int words, int s, uint64_t fill)
+{
+    if (s >= 0) {
+        int q = s >> 6, b = s & 63;
+        for (int i = 0; i < words; ++i) {
+            uint64_t lo = (i + q < words) ? src[i + q] : fill;
+            if (b == 0) { dst[i] = lo; continue; }
+            uint64_t hi = (i + q + 1 < words) ? src[i + q + 1] : fill;
+            dst[i] = (lo >> b) | (hi << (64 - b));
+        }
+    } else {
+        int t = -s, q = t >> 6, b = t & 63;
+        for (int i = 0; i < words; ++i) {
+            uint64_t lo = (i - q >= 0) ? src[i - q] : fill;
+            if (b == 0) { dst[i] = lo; continue; }
+            uint64_t prev = (i - q - 1 >= 0) ? src[i - q - 1] : fill;
+            dst[i] = (lo << b) | (prev >> (64 - b));
+        }
+    }
+}
+
+// row[x] = op(row[x .. x + dir*(len-1)]), fenêtre construite par doublement
+// (recouvrement permis car op idempotent) : O(log len) opérations par mot
+static void windowBits(uint64_t* row, uint64_t* tmp, int words, int width, int len, int dir, bool isErode)
+{
+    uint64_t fill = isErode ? ~uint64_t(0) : 0;
+    for (int cur = 1; cur < len; ) {
+        int step = std::min(cur, len - cur);
+        shiftBits(row, tmp, words, dir * step, fill);
+        if (isErode) for (int i = 0; i < words; ++i) row[i] &= tmp[i];
+        else         for (int i = 0; i < words; ++i) row[i] |= tmp[i];
+        fixTail(row, words, width, fill);
+        cur += step;
+    }
+}
+
+// Passe horizontale : row[x] = op(row[x - k/2 .. x - k/2 + k - 1]),
+// découpée en une fenêtre arrière [x - k/2, x] et une fenêtre avant [x, x + k - 1 - k/2]
+static void morphRow(uint64_t* row, uint64_t* back, uint64_t* tmp, int words, int width, int k, bool isErode)
+{
+    uint64_t fill = isErode ? ~uint64_t(0) : 0;
+    fixTail(row, words, width, fill);
+    std::copy(row, row + words, back);
+
+    windowBits(back, tmp, words, width, k / 2 + 1, -1, isErode);
+    windowBits(row, tmp, words, width, k - k / 2, 1, isErode);
+
+    if (isErode) for (int i = 0; i < words; ++i) row[i] &= back[i];
+    else         for (int i = 0; i < words; ++i) row[i] |= back[i];
+}
+
+// Passe verticale van Herk / Gil-Werman sur des mots entiers : 3 opérations par mot,
+// quel que soit k. Séquence complétée par k/2 lignes neutres de chaque côté,
+// découpée en blocs de k lignes ; g = cumul depuis le début du bloc, h = cumul jusqu'à la fin.
+static void morphColumns(BitMask& m, int k, bool isErode)
+{
+    if (k <= 1 || m.height == 0 || m.words == 0) return;
+
+    uint64_t fill = isErode ? ~uint64_t(0) : 0;
+    int words = m.words;
+    int ay = k / 2;
+    int len = m.height + k - 1;
+    int nBlocks = (len + k - 1) / k;
+
+    std::vector<uint64_t> g(static_cast<size_t>(len) * words);
+    std::vector<uint64_t> h(static_cast<size_t>(len) * words);
+    std::vector<uint64_t> fillRow(words, fill);
+
+    auto source = [&](int p) -> const uint64_t* {
+        int y = p - ay;
+        return (y >= 0 && y < m.height) ? m.row(y) : fillRow.data();
+    };
+
+    parallelFor(0, nBlocks, [&](int b0, int b1) {
+        for (int b = b0; b < b1; ++b) {
+            int start = b * k;
+            int stop = std::min(len, start + k);
+
+            std::copy(source(start), source(start) + words, &g[static_cast<size_t>(start) * words]);
+            for (int p = start + 1; p < stop; ++p) {
+                const uint64_t* s = source(p);
+                const uint64_t* prev = &g[static_cast<size_t>(p - 1) * words];
+                uint64_t* cur = &g[static_cast<size_t>(p) * words];
+                if (isErode) for (int i = 0; i < words; ++i) cur[i] = prev[i] & s[i];
+                else         for (int i = 0; i < words; ++i) cur[i] = prev[i] | s[i];
+            }
+
+            std::copy(source(stop - 1), source(stop - 1) + words, &h[static_cast<size_t>(stop - 1) * words]);
+            for (int p = stop - 2; p >= start; --p) {
+                const uint64_t* s = source(p);
+                const uint64_t* next = &h[static_cast<size_t>(p + 1) * words];
+                uint64_t* cur = &h[static_cast<size_t>(p) * words];
+                if (isErode) for (int i = 0; i < words; ++i) cur[i] = next[i] & s[i];
+                else         for (int i = 0; i < words; ++i) cur[i] = next[i] | s[i];
+            }
+        }
+    }, 1);
+
+    parallelFor(0, m.height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const uint64_t* a = &h[static_cast<size_t>(y) * words];
+            const uint64_t* b = &g[static_cast<size_t>(y + k - 1) * words];
+            uint64_t* out = m.row(y);
+            if (isErode) for (int i = 0; i < words; ++i) out[i] = a[i] & b[i];
+            else         for (int i = 0; i < words; ++i) out[i] = a[i] | b[i];
+        }
+    });
+}
+
+static void morphPass(BitMask& m, int kw, int kh, bool isErode)
+{
+    if (kw > 1) {
+        parallelFor(0, m.height, [&](int y0, int y1) {
+            std::vector<uint64_t> back(m.words), tmp(m.words);
+            for (int y = y0; y < y1; ++y)
+                morphRow(m.row(y), back.data(), tmp.data(), m.words, m.width, kw, isErode);
+        });
+    }
+    morphColumns(m, kh, isErode);
+}
+
+Image Image::morphology(int kw, int kh, const char* ops) const
+{
+    if (channels != 1) throw std::invalid_argument("Morphology requires a 1-channel mask");
+    if (kw <= 0 || kh <= 0) throw std::invalid_argument("Structuring element must be positive");
+
+    BitMask mask(width, height);
+    parallelFor(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const unsigned char* src = row(y).data();
+            uint64_t* dst = mask.row(y);
+            for (int x = 0; x < width; ++x)
+                dst[x >> 6] |= static_cast<uint64_t>(src[x] != 0) << (x & 63);
+        }
+    });
+
+    for (const char* op = ops; *op; ++op)
+        morphPass(mask, kw, kh, *op == 'e');
+
     Image result(width, height, 1, "GRAY", 0);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            std::vector<unsigned char> tmp(channels);
-            for (int c = 0; c < channels; ++c) tmp[c] = getPixel(x, y, c);
-            result(x, y, 0) = thresholdPixel(tmp.data(), channels, threshold, '>');
+    parallelFor(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const uint64_t* src = mask.row(y);
+            unsigned char* dst = result.row(y).data();
+            for (int x = 0; x < width; ++x)
+                dst[x] = ((src[x >> 6] >> (x & 63)) & 1) ? 255 : 0;
         }
+    });
+    return result;
+}
+
+Image Image::erode(int kw, int kh) const
+{
+    return morphology(kw, kh, "e");
+}
+
+Image Image::dilate(int kw, int kh) const
+{
+    return morphology(kw, kh, "d");
+}
+
+Image Image::opening(int kw, int kh) const
+{
+    return morphology(kw, kh, "ed");
+}
+
+Image Image::closing(int kw, int kh) const
+{
+    return morphology(kw, kh, "de");
+}
+
+// Segment horizontal d'objet sur une ligne, bornes incluses
+struct Run
+{
+    int y;
+    int x0, x1;
+};
+
+static int findRoot(std::vector<int>& parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// La plus petite racine l'emporte : la racine d'une composante est son premier run
+static void unite(std::vector<int>& parent, int a, int b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a < b) parent[b] = a;
+    else if (b < a) parent[a] = b;
+}
+
+// Relie les runs [a0, a1) d'une ligne aux runs [b0, b1) de la ligne suivante
+static void linkRows(std::vector<int>& parent, const std::vector<Run>& runs,
+                     int a0, int a1, int b0, int b1, int slack)
+{
+    int i = a0, j = b0;
+    while (i < a1 && j < b1) {
+        const Run& r = runs[i];
+        const Run& s = runs[j];
+        if (r.x1 + slack >= s.x0 && s.x1 + slack >= r.x0) unite(parent, i, j);
+        if (r.x1 < s.x1) ++i;
+        else ++j;
+    }
+}
+
+std::vector<Image::Blob> Image::connectedComponents(int connectivity, std::vector<int>* labels) const
+{
+    if (channels != 1) throw std::invalid_argument("Connected components require a 1-channel mask");
+    if (connectivity != 4 && connectivity != 8) throw std::invalid_argument("Connectivity must be 4 or 8");
+
+    if (labels) labels->assign(static_cast<size_t>(width) * height, 0);
+    if (width == 0 || height == 0) return std::vector<Blob>();
+
+    // 1. Extraction des runs, une bande de lignes par tâche
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    int nBands = std::max(1, std::min(height, hw * 4));
+    int bandRows = (height + nBands - 1) / nBands;
+    nBands = (height + bandRows - 1) / bandRows;
+
+    std::vector<std::vector<Run>> bandRuns(nBands);
+    std::vector<int> rowStart(height + 1, 0);
+
+    parallelFor(0, nBands, [&](int b0, int b1) {
+        for (int b = b0; b < b1; ++b) {
+            int yEnd = std::min(height, (b + 1) * bandRows);
+            for (int y = b * bandRows; y < yEnd; ++y) {
+                const unsigned char* p = row(y).data();
+                size_t before = bandRuns[b].size();
+                int x = 0;
+                while (x < width) {
+                    while (x < width && !p[x]) ++x;
+                    if (x == width) break;
+                    int start = x;
+                    while (x < width && p[x]) ++x;
+                    bandRuns[b].push_back(Run{ y, start, x - 1 });
+                }
+                rowStart[y + 1] = static_cast<int>(bandRuns[b].size() - before);
+            }
+        }
+    }, 1);
+
+    for (int y = 0; y < height; ++y) rowStart[y + 1] += rowStart[y];
+
+    std::vector<Run> runs(rowStart[height]);
+    std::vector<int> parent(runs.size());
+    int slack = (connectivity == 8) ? 1 : 0;
+
+    // 2. Union-find à l'intérieur de chaque bande (indices disjoints entre bandes)
+    parallelFor(0, nBands, [&](int b0, int b1) {
+        for (int b = b0; b < b1; ++b) {
+            int yBegin = b * bandRows;
+            int yEnd = std::min(height, yBegin + bandRows);
+            std::copy(bandRuns[b].begin(), bandRuns[b].end(), runs.begin() + rowStart[yBegin]);
+            for (int i = rowStart[yBegin]; i < rowStart[yEnd]; ++i) parent[i] = i;
+            for (int y = yBegin + 1; y < yEnd; ++y)
+                linkRows(parent, runs, rowStart[y - 1], rowStart[y], rowStart[y], rowStart[y + 1], slack);
+        }
+    }, 1);
+
+    // 3. Fusion aux frontières entre bandes
+    for (int b = 1; b < nBands; ++b) {
+        int y = b * bandRows;
+        linkRows(parent, runs, rowStart[y - 1], rowStart[y], rowStart[y], rowStart[y + 1], slack);
+    }
+
+    // 4. Numérotation dans l'ordre de balayage et statistiques
+    std::vector<Blob> blobs;
+    std::vector<int> label(runs.size());
+    std::vector<long long> sumX, sumY;
+
+    for (size_t i = 0; i < runs.size(); ++i) {
+        int root = findRoot(parent, static_cast<int>(i));
+        const Run& r = runs[i];
+        int len = r.x1 - r.x0 + 1;
+
+        if (root == static_cast<int>(i)) {
+            label[i] = static_cast<int>(blobs.size());
+            blobs.push_back(Blob{ 0, r.x0, r.y, r.x1, r.y, 0.0, 0.0 });
+            sumX.push_back(0);
+            sumY.push_back(0);
+        } else {
+            label[i] = label[root];
+        }
+
+        Blob& blob = blobs[label[i]];
+        blob.area += len;
+        blob.minX = std::min(blob.minX, r.x0);
+        blob.maxX = std::max(blob.maxX, r.x1);
+        blob.maxY = r.y;
+        sumX[label[i]] += static_cast<long long>(r.x0 + r.x1) * len / 2;
+        sumY[label[i]] += static_cast<long long>(r.y) * len;
     }
+
+    for (size_t k = 0; k < blobs.size(); ++k) {
+        blobs[k].cx = static_cast<double>(sumX[k]) / blobs[k].area;
+        blobs[k].cy = static_cast<double>(sumY[k]) / blobs[k].area;
+    }
+
+    if (labels) {
+        parallelFor(0, height, [&](int y0, int y1) {
+            for (int y = y0; y < y1; ++y) {
+                int* dst = &(*labels)[static_cast<size_t>(y) * width];
+                for (int i = rowStart[y]; i < rowStart[y + 1]; ++i)
+                    std::fill(dst + runs[i].x0, dst + runs[i].x1 + 1, label[i] + 1);
+            }
+        });
+    }
+
+    return blobs;
+}
+
+enum ColorModel { MODEL_GRAY, MODEL_RGB, MODEL_RGBA, MODEL_BGR, MODEL_YUV };
+
+static ColorModel parseModel(const std::string& m)
+{
+    if (m == "GRAY") return MODEL_GRAY;
+    if (m == "RGB")  return MODEL_RGB;
+    if (m == "RGBA") return MODEL_RGBA;
+    if (m == "BGR")  return MODEL_BGR;
+    if (m == "YUV")  return MODEL_YUV;
+    throw std::invalid_argument("Unsupported color model: " + m);
+}
+
+static int modelChannels(ColorModel m)
+{
+    switch (m) {
+    case MODEL_GRAY: return 1;
+    case MODEL_RGBA: return 4;
+    default:         return 3;
+    }
+}
+
+static inline unsigned char saturate(int v)
+{
+    return static_cast<unsigned char>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// Coefficients BT.601 en virgule fixe Q14 (chaque ligne RGB -> Y/U/V somme à 16384 ou 0)
+static const int Q = 14;
+static const int HALF = 1 << (Q - 1);
+
+#ifdef IMAGE_SSSE3
+// Noyaux SSSE3 : 16 pixels par itération (pshufb pour les permutations, pmaddwd pour YUV),
+// résultats identiques bit à bit aux boucles scalaires. Choisis à l'exécution si le CPU le permet.
+static bool cpuHasSsse3()
+{
+    static const bool supported = __builtin_cpu_supports("ssse3") != 0;
+    return supported;
+}
+
+// Désentrelacement de 16 pixels RGB (3 registres) : [plan][registre source]
+static const signed char DEINTERLEAVE3[3][3][16] = {
+    { {    0,    3,    6,    9,   12,   15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128 },
+      { -128, -128, -128, -128, -128, -128,    2,    5,    8,   11,   14, -128, -128, -128, -128, -128 },
+      { -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,    1,    4,    7,   10,   13 } },
+    { {    1,    4,    7,   10,   13, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128 },
+      { -128, -128, -128, -128, -128,    0,    3,    6,    9,   12,   15, -128, -128, -128, -128, -128 },
+      { -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,    2,    5,    8,   11,   14 } },
+    { {    2,    5,    8,   11,   14, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128 },
+      { -128, -128, -128, -128, -128,    1,    4,    7,   10,   13, -128, -128, -128, -128, -128, -128 },
+      { -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,    0,    3,    6,    9,   12,   15 } },
+};
+
+// Entrelacement inverse : [registre destination][plan]
+static const signed char INTERLEAVE3[3][3][16] = {
+    { {    0, -128, -128,    1, -128, -128,    2, -128, -128,    3, -128, -128,    4, -128, -128,    5 },
+      { -128,    0, -128, -128,    1, -128, -128,    2, -128, -128,    3, -128, -128,    4, -128, -128 },
+      { -128, -128,    0, -128, -128,    1, -128, -128,    2, -128, -128,    3, -128, -128,    4, -128 } },
+    { { -128, -128,    6, -128, -128,    7, -128, -128,    8, -128, -128,    9, -128, -128,   10, -128 },
+      {    5, -128, -128,    6, -128, -128,    7, -128, -128,    8, -128, -128,    9, -128, -128,   10 },
+      { -128,    5, -128, -128,    6, -128, -128,    7, -128, -128,    8, -128, -128,    9, -128, -128 } },
+    { { -128,   11, -128, -128,   12, -128, -128,   13, -128, -128,   14, -128, -128,   15, -128, -128 },
+      { -128, -128,   11, -128, -128,   12, -128, -128,   13, -128, -128,   14, -128, -128,   15, -128 },
+      {   10, -128, -128,   11, -128, -128,   12, -128, -128,   13, -128, -128,   14, -128, -128,   15 } },
+};
+
+// 4 pixels RGBA -> 12 octets RGB, et l'inverse (alpha à 0, ajouté ensuite)
+static const signed char RGBA_TO_RGB[16] = {    0,    1,    2,    4,    5,    6,    8,    9,   10,   12,   13,   14, -128, -128, -128, -128 };
+static const signed char RGB_TO_RGBA[16] = {    0,    1,    2, -128,    3,    4,    5, -128,    6,    7,    8, -128,    9,   10,   11, -128 };
+
+SSSE3_FN static inline __m128i loadMask(const signed char* m)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(m));
+}
+
+SSSE3_FN static inline __m128i load16(const unsigned char* p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+SSSE3_FN static inline void store16(unsigned char* p, __m128i v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+// 48 octets entrelacés -> 3 plans de 16 octets
+SSSE3_FN static inline void loadPlanes(const unsigned char* src, __m128i planes[3])
+{
+    __m128i v[3] = { load16(src), load16(src + 16), load16(src + 32) };
+    for (int c = 0; c < 3; ++c) {
+        planes[c] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v[0], loadMask(DEINTERLEAVE3[c][0])),
+                                              _mm_shuffle_epi8(v[1], loadMask(DEINTERLEAVE3[c][1]))),
+                                 _mm_shuffle_epi8(v[2], loadMask(DEINTERLEAVE3[c][2])));
+    }
+}
+
+// 3 plans de 16 octets -> 48 octets entrelacés
+SSSE3_FN static inline void storePlanes(unsigned char* dst, __m128i p0, __m128i p1, __m128i p2)
+{
+    for (int r = 0; r < 3; ++r) {
+        store16(dst + 16 * r,
+                _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(p0, loadMask(INTERLEAVE3[r][0])),
+                                          _mm_shuffle_epi8(p1, loadMask(INTERLEAVE3[r][1]))),
+                             _mm_shuffle_epi8(p2, loadMask(INTERLEAVE3[r][2]))));
+    }
+}
+
+// (ca*a + cb*b + cc*c + HALF) >> Q sur 8 voies int16, calcul en int32 via pmaddwd
+SSSE3_FN static inline __m128i fixedDot8(__m128i a, __m128i b, __m128i c, int ca, int cb, int cc)
+{
+    __m128i kab = _mm_set1_epi32(static_cast<int>((static_cast<unsigned>(cb) << 16) | (ca & 0xFFFF)));
+    __m128i kc = _mm_set1_epi32(static_cast<int>((static_cast<unsigned>(HALF) << 16) | (cc & 0xFFFF)));
+    __m128i one = _mm_set1_epi16(1);
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), kab),
+                               _mm_madd_epi16(_mm_unpacklo_epi16(c, one), kc));
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), kab),
+                               _mm_madd_epi16(_mm_unpackhi_epi16(c, one), kc));
+    return _mm_packs_epi32(_mm_srai_epi32(lo, Q), _mm_srai_epi32(hi, Q));
+}
+
+// Même calcul sur 16 octets : résultat saturé 0..255, plus offset (0 ou 128) avant saturation
+SSSE3_FN static inline __m128i fixedDot16(const __m128i in[3], int ca, int cb, int cc, int offset)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i off = _mm_set1_epi16(static_cast<short>(offset));
+    __m128i lo = fixedDot8(_mm_unpacklo_epi8(in[0], zero), _mm_unpacklo_epi8(in[1], zero),
+                           _mm_unpacklo_epi8(in[2], zero), ca, cb, cc);
+    __m128i hi = fixedDot8(_mm_unpackhi_epi8(in[0], zero), _mm_unpackhi_epi8(in[1], zero),
+                           _mm_unpackhi_epi8(in[2], zero), ca, cb, cc);
+    return _mm_packus_epi16(_mm_add_epi16(lo, off), _mm_add_epi16(hi, off));
+}
+
+// Renvoie le nombre de pixels traités (multiple de 16) ; le reste est fait en scalaire
+SSSE3_FN static int rowToRgbSsse3(ColorModel from, const unsigned char* src, unsigned char* dst, int n)
+{
+    int i = 0;
+    switch (from) {
+    case MODEL_GRAY:
+        for (; i + 16 <= n; i += 16) {
+            __m128i g = load16(src + i);
+            storePlanes(dst + 3 * i, g, g, g);
+        }
+        break;
+    case MODEL_RGBA: {
+        __m128i m = loadMask(RGBA_TO_RGB);
+        for (; i + 16 <= n; i += 16) {
+            __m128i t0 = _mm_shuffle_epi8(load16(src + 4 * i), m);
+            __m128i t1 = _mm_shuffle_epi8(load16(src + 4 * i + 16), m);
+            __m128i t2 = _mm_shuffle_epi8(load16(src + 4 * i + 32), m);
+            __m128i t3 = _mm_shuffle_epi8(load16(src + 4 * i + 48), m);
+            store16(dst + 3 * i,      _mm_or_si128(t0, _mm_slli_si128(t1, 12)));
+            store16(dst + 3 * i + 16, _mm_or_si128(_mm_srli_si128(t1, 4), _mm_slli_si128(t2, 8)));
+            store16(dst + 3 * i + 32, _mm_or_si128(_mm_srli_si128(t2, 8), _mm_slli_si128(t3, 4)));
+        }
+        break;
+    }
+    case MODEL_BGR:
+        for (; i + 16 <= n; i += 16) {
+            __m128i p[3];
+            loadPlanes(src + 3 * i, p);
+            storePlanes(dst + 3 * i, p[2], p[1], p[0]);
+        }
+        break;
+    case MODEL_YUV: {
+        __m128i bias = _mm_set1_epi8(static_cast<char>(-128));
+        for (; i + 16 <= n; i += 16) {
+            __m128i p[3];
+            loadPlanes(src + 3 * i, p);
+            // Y, U-128, V-128 : U et V centrés passent en int16 signés par extension de signe
+            __m128i zero = _mm_setzero_si128();
+            __m128i u = _mm_xor_si128(p[1], bias), v = _mm_xor_si128(p[2], bias);
+            __m128i uLo = _mm_srai_epi16(_mm_unpacklo_epi8(zero, u), 8), uHi = _mm_srai_epi16(_mm_unpackhi_epi8(zero, u), 8);
+            __m128i vLo = _mm_srai_epi16(_mm_unpacklo_epi8(zero, v), 8), vHi = _mm_srai_epi16(_mm_unpackhi_epi8(zero, v), 8);
+            __m128i yLo = _mm_unpacklo_epi8(p[0], zero), yHi = _mm_unpackhi_epi8(p[0], zero);
+
+            __m128i r = _mm_packus_epi16(fixedDot8(yLo, vLo, uLo, 1 << Q, 22970, 0),
+                                         fixedDot8(yHi, vHi, uHi, 1 << Q, 22970, 0));
+            __m128i g = _mm_packus_epi16(fixedDot8(yLo, uLo, vLo, 1 << Q, -5638, -11700),
+                                         fixedDot8(yHi, uHi, vHi, 1 << Q, -5638, -11700));
+            __m128i b = _mm_packus_epi16(fixedDot8(yLo, uLo, vLo, 1 << Q, 29032, 0),
+                                         fixedDot8(yHi, uHi, vHi, 1 << Q, 29032, 0));
+            storePlanes(dst + 3 * i, r, g, b);
+        }
+        break;
+    }
+    case MODEL_RGB:
+        break;
+    }
+    return i;
+}
+
+SSSE3_FN static int rowFromRgbSsse3(ColorModel to, const unsigned char* src, unsigned char* dst, int n)
+{
+    int i = 0;
+    switch (to) {
+    case MODEL_GRAY: {
+        __m128i zero = _mm_setzero_si128();
+        __m128i kr = _mm_set1_epi16(77), kg = _mm_set1_epi16(150), kb = _mm_set1_epi16(29);
+        __m128i round = _mm_set1_epi16(128);
+        for (; i + 16 <= n; i += 16) {
+            __m128i p[3];
+            loadPlanes(src + 3 * i, p);
+            // 77r + 150g + 29b + 128 <= 65408 : tient en uint16
+            __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p[0], zero), kr),
+                                                     _mm_mullo_epi16(_mm_unpacklo_epi8(p[1], zero), kg)),
+                                       _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p[2], zero), kb), round));
+            __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p[0], zero), kr),
+                                                     _mm_mullo_epi16(_mm_unpackhi_epi8(p[1], zero), kg)),
+                                       _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p[2], zero), kb), round));
+            store16(dst + i, _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+        }
+        break;
+    }
+    case MODEL_RGBA: {
+        __m128i m = loadMask(RGB_TO_RGBA);
+        __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        for (; i + 16 <= n; i += 16) {
+            __m128i v0 = load16(src + 3 * i), v1 = load16(src + 3 * i + 16), v2 = load16(src + 3 * i + 32);
+            store16(dst + 4 * i,      _mm_or_si128(_mm_shuffle_epi8(v0, m), alpha));
+            store16(dst + 4 * i + 16, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(v1, v0, 12), m), alpha));
+            store16(dst + 4 * i + 32, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(v2, v1, 8), m), alpha));
+            store16(dst + 4 * i + 48, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(v2, 4), m), alpha));
+        }
+        break;
+    }
+    case MODEL_BGR:
+        i = rowToRgbSsse3(MODEL_BGR, src, dst, n);
+        break;
+    case MODEL_YUV:
+        for (; i + 16 <= n; i += 16) {
+            __m128i p[3];
+            loadPlanes(src + 3 * i, p);
+            storePlanes(dst + 3 * i,
+                        fixedDot16(p, 4899, 9617, 1868, 0),
+                        fixedDot16(p, -2765, -5427, 8192, 128),
+                        fixedDot16(p, 8192, -6860, -1332, 128));
+        }
+        break;
+    case MODEL_RGB:
+        break;
+    }
+    return i;
+}
+#endif
+
+// Conversion d'une ligne de n pixels vers RGB : blocs SSSE3 puis reste en scalaire
+static void rowToRgb(ColorModel from, const unsigned char* src, unsigned char* dst, int n)
+{
+    int i = 0;
+#ifdef IMAGE_SSSE3
+    if (cpuHasSsse3()) i = rowToRgbSsse3(from, src, dst, n);
+#endif
+
+    switch (from) {
+    case MODEL_GRAY:
+        for (; i < n; ++i) {
+            dst[3 * i] = dst[3 * i + 1] = dst[3 * i + 2] = src[i];
+        }
+        break;
+    case MODEL_RGBA:
+        for (; i < n; ++i) {
+            dst[3 * i]     = src[4 * i];
+            dst[3 * i + 1] = src[4 * i + 1];
+            dst[3 * i + 2] = src[4 * i + 2];
+        }
+        break;
+    case MODEL_BGR:
+        for (; i < n; ++i) {
+            dst[3 * i]     = src[3 * i + 2];
+            dst[3 * i + 1] = src[3 * i + 1];
+            dst[3 * i + 2] = src[3 * i];
+        }
+        break;
+    case MODEL_YUV:
+        for (; i < n; ++i) {
+            int y = (src[3 * i] << Q) + HALF;
+            int u = src[3 * i + 1] - 128;
+            int v = src[3 * i + 2] - 128;
+            dst[3 * i]     = saturate((y + 22970 * v) >> Q);
+            dst[3 * i + 1] = saturate((y - 5638 * u - 11700 * v) >> Q);
+            dst[3 * i + 2] = saturate((y + 29032 * u) >> Q);
+        }
+        break;
+    case MODEL_RGB:
+        std::copy(src, src + 3 * static_cast<size_t>(n), dst);
+        break;
+    }
+}
+
+// Conversion d'une ligne de n pixels RGB vers un autre modèle
+static void rowFromRgb(ColorModel to, const unsigned char* src, unsigned char* dst, int n)
+{
+    int i = 0;
+#ifdef IMAGE_SSSE3
+    if (cpuHasSsse3()) i = rowFromRgbSsse3(to, src, dst, n);
+#endif
+
+    switch (to) {
+    case MODEL_GRAY:
+        for (; i < n; ++i) {
+            dst[i] = static_cast<unsigned char>((77 * src[3 * i] + 150 * src[3 * i + 1] + 29 * src[3 * i + 2] + 128) >> 8);
+        }
+        break;
+    case MODEL_RGBA:
+        for (; i < n; ++i) {
+            dst[4 * i]     = src[3 * i];
+            dst[4 * i + 1] = src[3 * i + 1];
+            dst[4 * i + 2] = src[3 * i + 2];
+            dst[4 * i + 3] = 255;
+        }
+        break;
+    case MODEL_BGR:
+        rowToRgb(MODEL_BGR, src + 3 * static_cast<size_t>(i), dst + 3 * static_cast<size_t>(i), n - i);// échange R/B symétrique
+        break;
+    case MODEL_YUV:
+        for (; i < n; ++i) {
+            int r = src[3 * i], g = src[3 * i + 1], b = src[3 * i + 2];
+            dst[3 * i]     = saturate((4899 * r + 9617 * g + 1868 * b + HALF) >> Q);
+            dst[3 * i + 1] = saturate(((-2765 * r - 5427 * g + 8192 * b + HALF) >> Q) + 128);
+            dst[3 * i + 2] = saturate(((8192 * r - 6860 * g - 1332 * b + HALF) >> Q) + 128);
+        }
+        break;
+    case MODEL_RGB:
+        std::copy(src, src + 3 * static_cast<size_t>(n), dst);
+        break;
+    }
+}
+
+Image Image::convert(const std::string& targetModel) const
+{
+    Image result;
+    convert(targetModel, result);
     return result;
 }
 
-Image Image::operator>=(int threshold) const
+void Image::convert(const std::string& targetModel, Image& dst) const
 {
-    Image result(width, height, 1, "GRAY", 0);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            std::vector<unsigned char> tmp(channels);
-            for (int c = 0; c < channels; ++c) tmp[c] = getPixel(x, y, c);
-            result(x, y, 0) = thresholdPixel(tmp.data(), channels, threshold, 'g');
+    ColorModel from = parseModel(model);
+    ColorModel to = parseModel(targetModel);
+    if (modelChannels(from) != channels)
+        throw std::invalid_argument("Channels do not match color model");
+
+    if (&dst == this) {
+        Image tmp;
+        convert(targetModel, tmp);
+        dst = std::move(tmp);
+        return;
+    }
+
+    int dstCh = modelChannels(to);
+    dst.reshape(width, height, dstCh, targetModel);
+
+    parallelFor(0, height, [&](int y0, int y1) {
+        std::vector<unsigned char> rgb;
+        if (from != MODEL_RGB && to != MODEL_RGB && from != to) rgb.resize(static_cast<size_t>(width) * 3);
+
+        for (int y = y0; y < y1; ++y) {
+            const unsigned char* src = row(y).data();
+            unsigned char* out = dst.pixels.data() + static_cast<size_t>(y) * width * dstCh;
+            if (from == to)
+                std::copy(src, src + static_cast<size_t>(width) * channels, out);
+            else if (to == MODEL_RGB)
+                rowToRgb(from, src, out, width);
+            else if (from == MODEL_RGB)
+                rowFromRgb(to, src, out, width);
+            else {
+                rowToRgb(from, src, rgb.data(), width);
+                rowFromRgb(to, rgb.data(), out, width);
+            }
         }
+    });
+}
+
+static void checkSameDimensions(const Image& a, const Image& b)
+{
+    if (a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight())
+        throw std::invalid_argument("Images have different dimensions");
+}
+
+// Somme des |a - b| sur n échantillons. Blocs de 16 à longueur fixe et accumulateur 32 bits :
+// c'est la forme que GCC vectorise dès -O2 (le modèle de coût -O2 exige un nombre d'itérations connu)
+static unsigned long long sadSpan(const unsigned char* a, const unsigned char* b, size_t n)
+{
+    const size_t block = 1 << 16;// 65536 * 255 tient dans 32 bits
+    unsigned long long total = 0;
+    size_t i = 0;
+    while (i + 16 <= n) {
+        size_t stop = i + std::min(block, (n - i) & ~static_cast<size_t>(15));
+        unsigned int acc = 0;
+        for (; i < stop; i += 16) {
+            for (int k = 0; k < 16; ++k) {
+                int x = a[i + k], y = b[i + k];
+                acc += (x > y) ? x - y : y - x;
+            }
+        }
+        total += acc;
     }
+    for (; i < n; ++i) total += (a[i] > b[i]) ? a[i] - b[i] : b[i] - a[i];
+    return total;
+}
+
+// Nombre d'échantillons avec |a - b| > threshold ; même découpage que sadSpan
+static size_t countSpan(const unsigned char* a, const unsigned char* b, size_t n, int threshold)
+{
+    size_t count = 0;
+    size_t i = 0;
+    while (i + 16 <= n) {
+        size_t stop = i + std::min(static_cast<size_t>(1) << 30, (n - i) & ~static_cast<size_t>(15));
+        unsigned int acc = 0;
+        for (; i < stop; i += 16) {
+            for (int k = 0; k < 16; ++k) {
+                int x = a[i + k], y = b[i + k];
+                int d = (x > y) ? x - y : y - x;
+                acc += (d > threshold);
+            }
+        }
+        count += acc;
+    }
+    for (; i < n; ++i) {
+        int d = (a[i] > b[i]) ? a[i] - b[i] : b[i] - a[i];
+        count += (d > threshold);
+    }
+    return count;
+}
+
+unsigned long long Image::sumAbsDiff(const Image& other, unsigned long long limit) const
+{
+    checkSameFormat(other);
+    checkSameDimensions(*this, other);
+
+    std::atomic<unsigned long long> total(0);
+    parallelFor(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            if (total.load(std::memory_order_relaxed) > limit) break;// un autre thread a déjà conclu
+            unsigned long long s = sadSpan(row(y).data(), other.row(y).data(), stride());
+            if (total.fetch_add(s) + s > limit) break;
+        }
+    });
+    return total.load();
+}
+
+size_t Image::countChanged(const Image& other, int threshold, size_t limit) const
+{
+    checkSameFormat(other);
+    checkSameDimensions(*this, other);
+
+    std::atomic<size_t> total(0);
+    parallelFor(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            if (total.load(std::memory_order_relaxed) > limit) break;// un autre thread a déjà conclu
+            size_t c = countSpan(row(y).data(), other.row(y).data(), stride(), threshold);
+            if (total.fetch_add(c) + c > limit) break;
+        }
+    });
+    return total.load();
+}
+
+bool Image::anyChanged(const Image& other, int threshold) const
+{
+    return countChanged(other, threshold, 0) > 0;
+}
+
+Image Image::changeMap(const Image& other, int tileSize, int threshold, size_t minChanged) const
+{
+    checkSameFormat(other);
+    checkSameDimensions(*this, other);
+    if (tileSize <= 0) throw std::invalid_argument("Tile size must be positive");
+
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesY = (height + tileSize - 1) / tileSize;
+    Image result(tilesX, tilesY, 1, "GRAY", 0);
+
+    parallelFor(0, tilesY, [&](int ty0, int ty1) {
+        std::vector<size_t> counts(tilesX);
+        for (int ty = ty0; ty < ty1; ++ty) {
+            std::fill(counts.begin(), counts.end(), 0);
+            int yEnd = std::min(height, (ty + 1) * tileSize);
+            for (int y = ty * tileSize; y < yEnd; ++y) {
+                const unsigned char* a = row(y).data();
+                const unsigned char* b = other.row(y).data();
+                for (int tx = 0; tx < tilesX; ++tx) {
+                    if (counts[tx] >= minChanged) continue;// tuile déjà marquée
+                    size_t x0 = static_cast<size_t>(tx) * tileSize * channels;
+                    size_t x1 = std::min(stride(), x0 + static_cast<size_t>(tileSize) * channels);
+                    counts[tx] += countSpan(a + x0, b + x0, x1 - x0, threshold);
+                }
+            }
+            unsigned char* out = result.row(ty).data();
+            for (int tx = 0; tx < tilesX; ++tx)
+                out[tx] = (counts[tx] >= minChanged) ? 255 : 0;
+        }
+    }, 1);
     return result;
 }
 
-Image Image::operator==(int threshold) const
+static const int TILE = 32;// côté des tuiles : src et dst d'une tuile tiennent en L1
+
+// Copie d'une tuile : pixel (x, y) de src -> pixel base + x*sx + y*sy de dst.
+// CH fixé (1, 3, 4) : copie d'un pixel déroulée par le compilateur ; CH = 0 : ch quelconque
+template <int CH>
+static void remapTile(const unsigned char* src, unsigned char* dst, int w, int ch,
+                      int x0, int x1, int y0, int y1, long long base, long long sx, long long sy)
 {
-    Image result(width, height, 1, "GRAY", 0);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            std::vector<unsigned char> tmp(channels);
-            for (int c = 0; c < channels; ++c) tmp[c] = getPixel(x, y, c);
-            result(x, y, 0) = thresholdPixel(tmp.data(), channels, threshold, '=');
+    const int n = CH ? CH : ch;
+    for (int y = y0; y < y1; ++y) {
+        const unsigned char* s = src + (static_cast<size_t>(y) * w + x0) * n;
+        long long d = base + x0 * sx + y * sy;
+        for (int x = x0; x < x1; ++x, s += n, d += sx) {
+            unsigned char* p = dst + d * n;
+            for (int c = 0; c < n; ++c) p[c] = s[c];
         }
     }
+}
+
+// Copie d'une zone quelconque de la tuile, CH choisi selon ch
+static void remapRect(const unsigned char* src, unsigned char* dst, int w, int ch,
+                      int x0, int x1, int y0, int y1, long long base, long long sx, long long sy)
+{
+    if (x0 >= x1 || y0 >= y1) return;
+    switch (ch) {
+    case 1:  remapTile<1>(src, dst, w, ch, x0, x1, y0, y1, base, sx, sy); break;
+    case 3:  remapTile<3>(src, dst, w, ch, x0, x1, y0, y1, base, sx, sy); break;
+    case 4:  remapTile<4>(src, dst, w, ch, x0, x1, y0, y1, base, sx, sy); break;
+    default: remapTile<0>(src, dst, w, ch, x0, x1, y0, y1, base, sx, sy); break;
+    }
+}
+
+#ifdef IMAGE_SSSE3
+// Transposition de blocs en registres : out[j][k] = in[k][j] (pixel j de la ligne source k).
+// 8×8 pixels 1 canal, 4×4 pixels 4 canaux (mots de 32 bits), 4×4 pixels 3 canaux étendus à 32 bits.
+SSSE3_FN static inline void transposeBlock8x8(const unsigned char* const* in, unsigned char* const* out)
+{
+    __m128i a[4], b[4];
+    for (int k = 0; k < 4; ++k)
+        a[k] = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in[2 * k])),
+                                 _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in[2 * k + 1])));
+    b[0] = _mm_unpacklo_epi16(a[0], a[1]);
+    b[1] = _mm_unpackhi_epi16(a[0], a[1]);
+    b[2] = _mm_unpacklo_epi16(a[2], a[3]);
+    b[3] = _mm_unpackhi_epi16(a[2], a[3]);
+    __m128i c[4] = { _mm_unpacklo_epi32(b[0], b[2]), _mm_unpackhi_epi32(b[0], b[2]),
+                     _mm_unpacklo_epi32(b[1], b[3]), _mm_unpackhi_epi32(b[1], b[3]) };
+    for (int k = 0; k < 4; ++k) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out[2 * k]), c[k]);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out[2 * k + 1]), _mm_unpackhi_epi64(c[k], c[k]));
+    }
+}
+
+SSSE3_FN static inline void transpose4x4Words(__m128i r[4])
+{
+    __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]), t1 = _mm_unpacklo_epi32(r[2], r[3]);
+    __m128i t2 = _mm_unpackhi_epi32(r[0], r[1]), t3 = _mm_unpackhi_epi32(r[2], r[3]);
+    r[0] = _mm_unpacklo_epi64(t0, t1);
+    r[1] = _mm_unpackhi_epi64(t0, t1);
+    r[2] = _mm_unpacklo_epi64(t2, t3);
+    r[3] = _mm_unpackhi_epi64(t2, t3);
+}
+
+SSSE3_FN static inline void transposeBlock4x4Rgba(const unsigned char* const* in, unsigned char* const* out)
+{
+    __m128i r[4];
+    for (int k = 0; k < 4; ++k) r[k] = load16(in[k]);
+    transpose4x4Words(r);
+    for (int k = 0; k < 4; ++k) store16(out[k], r[k]);
+}
+
+// 12 octets par ligne : lectures et écritures 8 + 4 octets pour ne pas déborder de l'image
+SSSE3_FN static inline void transposeBlock4x4Rgb(const unsigned char* const* in, unsigned char* const* out)
+{
+    __m128i expand = loadMask(RGB_TO_RGBA), compact = loadMask(RGBA_TO_RGB);
+    __m128i r[4];
+    for (int k = 0; k < 4; ++k) {
+        int last;
+        std::memcpy(&last, in[k] + 8, 4);
+        __m128i v = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in[k])), _mm_cvtsi32_si128(last));
+        r[k] = _mm_shuffle_epi8(v, expand);
+    }
+    transpose4x4Words(r);
+    for (int k = 0; k < 4; ++k) {
+        __m128i v = _mm_shuffle_epi8(r[k], compact);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out[k]), v);
+        int last = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+        std::memcpy(out[k] + 8, &last, 4);
+    }
+}
+
+// Zone [x0, x1) × [y0, y1) en blocs b×b (dimensions multiples de b) ; |sy| = 1 : une colonne
+// de b pixels source devient b pixels contigus de dst (ordre inversé si sy = -1)
+SSSE3_FN static void remapBlocksSsse3(const unsigned char* src, unsigned char* dst, int w, int ch,
+                                      int x0, int x1, int y0, int y1, long long base, long long sx, long long sy)
+{
+    const int b = (ch == 1) ? 8 : 4;
+    const unsigned char* in[8];
+    unsigned char* out[8];
+    for (int by = y0; by < y1; by += b) {
+        int first = (sy > 0) ? by : by + b - 1;// ligne source du premier pixel de chaque ligne dst
+        for (int bx = x0; bx < x1; bx += b) {
+            for (int k = 0; k < b; ++k) {
+                int y = (sy > 0) ? by + k : by + b - 1 - k;
+                in[k] = src + (static_cast<size_t>(y) * w + bx) * ch;
+                out[k] = dst + (base + (bx + k) * sx + first * sy) * ch;
+            }
+            if (ch == 1) transposeBlock8x8(in, out);
+            else if (ch == 3) transposeBlock4x4Rgb(in, out);
+            else transposeBlock4x4Rgba(in, out);
+        }
+    }
+}
+#endif
+
+// Applique la correspondance de pixels par tuiles TILE×TILE, une bande de tuiles par tâche.
+// Transpositions et rotations de 90° (|sy| = 1) en 1, 3 ou 4 canaux : blocs SSSE3 si disponibles,
+// remapTile pour les bords et les autres cas
+static void remapImage(const Image& src, Image& dst, long long base, long long sx, long long sy)
+{
+    int w = src.getWidth(), h = src.getHeight(), ch = src.getChannels();
+    int tilesY = (h + TILE - 1) / TILE;
+    const unsigned char* in = src.data();
+    unsigned char* out = dst.data();
+
+    int block = 0;
+#ifdef IMAGE_SSSE3
+    if ((sy == 1 || sy == -1) && (ch == 1 || ch == 3 || ch == 4) && cpuHasSsse3()) block = (ch == 1) ? 8 : 4;
+#endif
+
+    parallelFor(0, tilesY, [&](int t0, int t1) {
+        for (int t = t0; t < t1; ++t) {
+            int y0 = t * TILE, y1 = std::min(h, y0 + TILE);
+            for (int x0 = 0; x0 < w; x0 += TILE) {
+                int x1 = std::min(w, x0 + TILE);
+                int bx1 = x0, by1 = y1;
+#ifdef IMAGE_SSSE3
+                if (block) {
+                    bx1 = x0 + (x1 - x0) / block * block;
+                    by1 = y0 + (y1 - y0) / block * block;
+                    remapBlocksSsse3(in, out, w, ch, x0, bx1, y0, by1, base, sx, sy);
+                }
+#endif
+                remapRect(in, out, w, ch, bx1, x1, y0, y1, base, sx, sy);// colonnes hors blocs
+                remapRect(in, out, w, ch, x0, bx1, by1, y1, base, sx, sy);// lignes hors blocs
+            }
+        }
+    }, 1);
+}
+
+Image Image::transpose() const
+{
+    Image result(height, width, channels, model);
+    remapImage(*this, result, 0, height, 1);
     return result;
 }
 
-Image Image::operator!=(int threshold) const
+Image Image::rotate90() const
 {
-    Image result(width, height, 1, "GRAY", 0);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            std::vector<unsigned char> tmp(channels);
-            for (int c = 0; c < channels; ++c) tmp[c] = getPixel(x, y, c);
-            result(x, y, 0) = thresholdPixel(tmp.data(), channels, threshold, 'n');
+    Image result(height, width, channels, model);
+    remapImage(*this, result, height - 1, height, -1);
+    return result;
+}
+
+Image Image::rotate180() const
+{
+    Image result(width, height, channels, model);
+    remapImage(*this, result, static_cast<long long>(width) * height - 1, -1, -static_cast<long long>(width));
+    return result;
+}
+
+Image Image::rotate270() const
+{
+    Image result(height, width, channels, model);
+    remapImage(*this, result, static_cast<long long>(width - 1) * height, -static_cast<long long>(height), 1);
+    return result;
+}
+
+Image Image::flipHorizontal() const
+{
+    Image result(width, height, channels, model);
+    remapImage(*this, result, width - 1, -1, width);
+    return result;
+}
+
+Image Image::flipVertical() const
+{
+    Image result(width, height, channels, model);
+    parallelFor(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            RowView<const unsigned char> src = row(y);
+            std::copy(src.begin(), src.end(), result.row(height - 1 - y).data());
         }
+    });
+    return result;
+}
+
+void Image::transposeInPlace()
+{
+    if (width != height) {
+        *this = transpose();
+        return;
     }
+
+    // Image carrée : échange des tuiles (i, j) et (j, i) ; tuiles diagonales échangées sur elles-mêmes.
+    // Répartition par paires de tuiles (triangle tj >= ti numéroté ligne par ligne) et non par
+    // lignes de tuiles : la première ligne du triangle en contient bien plus que la dernière
+    markAllDirty();
+    int n = width;
+    int tiles = (n + TILE - 1) / TILE;
+    int pairs = tiles * (tiles + 1) / 2;
+    parallelFor(0, pairs, [&](int p0, int p1) {
+        int ti = 0, rowStart = 0;
+        while (rowStart + (tiles - ti) <= p0) {
+            rowStart += tiles - ti;
+            ++ti;
+        }
+        int tj = ti + (p0 - rowStart);
+
+        for (int p = p0; p < p1; ++p) {
+            int y0 = ti * TILE, y1 = std::min(n, y0 + TILE);
+            int x0 = tj * TILE, x1 = std::min(n, x0 + TILE);
+            for (int y = y0; y < y1; ++y) {
+                for (int x = std::max(x0, y + 1); x < x1; ++x) {
+                    unsigned char* a = pixels.data() + getIndex(x, y, 0);
+                    unsigned char* b = pixels.data() + getIndex(y, x, 0);
+                    std::swap_ranges(a, a + channels, b);
+                }
+            }
+            if (++tj == tiles) {
+                ++ti;
+                tj = ti;
+            }
+        }
+    }, 1);
+}
+
+void Image::rotate90InPlace()
+{
+    if (width != height) {
+        *this = rotate90();
+        return;
+    }
+    transposeInPlace();
+    flipHorizontalInPlace();
+}
+
+void Image::rotate180InPlace()
+{
+    flipVerticalInPlace();
+    flipHorizontalInPlace();
+}
+
+void Image::rotate270InPlace()
+{
+    if (width != height) {
+        *this = rotate270();
+        return;
+    }
+    transposeInPlace();
+    flipVerticalInPlace();
+}
+
+// Marquage fait une fois avant la boucle parallèle : pas de row() non const entre threads
+void Image::flipHorizontalInPlace()
+{
+    markAllDirty();
+    parallelFor(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            unsigned char* p = pixels.data() + static_cast<size_t>(y) * stride();
+            for (int x = 0; x < width / 2; ++x) {
+                unsigned char* a = p + static_cast<size_t>(x) * channels;
+                unsigned char* b = p + static_cast<size_t>(width - 1 - x) * channels;
+                std::swap_ranges(a, a + channels, b);
+            }
+        }
+    });
+}
+
+void Image::flipVerticalInPlace()
+{
+    markAllDirty();
+    parallelFor(0, height / 2, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            unsigned char* top = pixels.data() + static_cast<size_t>(y) * stride();
+            unsigned char* bottom = pixels.data() + static_cast<size_t>(height - 1 - y) * stride();
+            std::swap_ranges(top, top + stride(), bottom);
+        }
+    });
+}
+
+Image Image::weightedSum(const std::vector<const Image*>& images, const std::vector<double>& weights)
+{
+    Image result;
+    weightedSum(images, weights, result);
     return result;
 }
 
-Image Image::operator~() const
+// Poids en Q14, accumulation entière 32 bits : une seule saturation en fin de calcul
+void Image::weightedSum(const std::vector<const Image*>& images, const std::vector<double>& weights, Image& dst)
 {
-    Image result(*this);
-    for (size_t i = 0; i < pixels.size(); ++i) {
-        result.pixels[i] = static_cast<unsigned char>(255 - pixels[i]);
+    if (images.empty() || images.size() != weights.size())
+        throw std::invalid_argument("Weights do not match images");
+
+    const Image& first = *images[0];
+    double totalWeight = 0.0;
+    std::vector<int> q(weights.size());
+    for (size_t k = 0; k < images.size(); ++k) {
+        first.checkSameFormat(*images[k]);
+        checkSameDimensions(first, *images[k]);
+        totalWeight += std::fabs(weights[k]);
+        q[k] = static_cast<int>(std::lround(weights[k] * (1 << Q)));
     }
+    if (totalWeight > 256.0) throw std::invalid_argument("Sum of absolute weights too large");
+
+    int w = first.width, h = first.height, ch = first.channels;
+    std::string m = first.model;// first peut être dst
+    dst.reshape(w, h, ch, m);
+
+    // Blocs de 16 dans des tableaux locaux : longueur fixe et aucun alias avec dst,
+    // donc vectorisé dès -O2. Chaque bloc est lu entièrement avant d'être écrit (dst peut être une entrée)
+    size_t n = dst.stride();
+    size_t count = images.size();
+    parallelFor(0, h, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            size_t offset = static_cast<size_t>(y) * n;
+            unsigned char* out = dst.pixels.data() + offset;
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                int acc[16];
+                for (int j = 0; j < 16; ++j) acc[j] = HALF;
+                for (size_t k = 0; k < count; ++k) {
+                    const unsigned char* p = images[k]->pixels.data() + offset + i;
+                    int wk = q[k];
+                    for (int j = 0; j < 16; ++j) acc[j] += wk * p[j];
+                }
+                unsigned char res[16];
+                for (int j = 0; j < 16; ++j) res[j] = saturate(acc[j] >> Q);
+                std::memcpy(out + i, res, sizeof(res));
+            }
+            for (; i < n; ++i) {
+                int acc = HALF;
+                for (size_t k = 0; k < count; ++k) acc += q[k] * images[k]->pixels[offset + i];
+                out[i] = saturate(acc >> Q);
+            }
+        }
+    });
+}
+
+Image Image::blend(const Image& a, const Image& b, const Image& alpha)
+{
+    Image result;
+    blend(a, b, alpha, result);
     return result;
 }
 
+// (a*α + b*(255-α)) / 255 arrondi exactement, sans division : t = num + 128, (t + (t >> 8)) >> 8
+void Image::blend(const Image& a, const Image& b, const Image& alpha, Image& dst)
+{
+    a.checkSameFormat(b);
+    checkSameDimensions(a, b);
+    checkSameDimensions(a, alpha);
+    if (alpha.channels != 1) throw std::invalid_argument("Alpha mask must have 1 channel");
+
+    // Le masque 1 canal ne peut pas recevoir un résultat à plusieurs canaux en place
+    if (&dst == &alpha && a.channels > 1) {
+        Image tmp;
+        blend(a, b, alpha, tmp);
+        dst = std::move(tmp);
+        return;
+    }
+
+    int w = a.width, h = a.height, ch = a.channels;
+    std::string m = a.model;// a peut être dst
+    dst.reshape(w, h, ch, m);
+
+    // Le masque est d'abord répété sur les canaux (ligne de w*ch octets), puis une boucle
+    // plate par blocs de 16 : alpha n'est plus rechargé par pixel et la boucle se vectorise dès -O2
+    size_t n = static_cast<size_t>(w) * ch;
+    parallelFor(0, h, [&](int y0, int y1) {
+        std::vector<unsigned char> expanded(ch > 1 ? n : 0);
+        for (int y = y0; y < y1; ++y) {
+            const unsigned char* pa = a.pixels.data() + static_cast<size_t>(y) * n;
+            const unsigned char* pb = b.pixels.data() + static_cast<size_t>(y) * n;
+            const unsigned char* pm = alpha.pixels.data() + static_cast<size_t>(y) * w;
+            unsigned char* out = dst.pixels.data() + static_cast<size_t>(y) * n;
+
+            if (ch == 3) {
+                rowToRgb(MODEL_GRAY, pm, expanded.data(), w);// même répétition que GRAY -> RGB
+                pm = expanded.data();
+            } else if (ch > 1) {
+                for (int x = 0; x < w; ++x)
+                    std::fill(expanded.begin() + static_cast<size_t>(x) * ch, expanded.begin() + static_cast<size_t>(x + 1) * ch, pm[x]);
+                pm = expanded.data();
+            }
+
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                unsigned char res[16];
+                for (int j = 0; j < 16; ++j) {
+                    int al = pm[i + j];
+                    int t = pa[i + j] * al + pb[i + j] * (255 - al) + 128;
+                    res[j] = static_cast<unsigned char>((t + (t >> 8)) >> 8);
+                }
+                std::memcpy(out + i, res, sizeof(res));
+            }
+            for (; i < n; ++i) {
+                int al = pm[i];
+                int t = pa[i] * al + pb[i] * (255 - al) + 128;
+                out[i] = static_cast<unsigned char>((t + (t >> 8)) >> 8);
+            }
+        }
+    });
+}
+
+Image Image::blend(const Image& a, const Image& b, double alpha)
+{
+    std::vector<const Image*> images(2);
+    images[0] = &a;
+    images[1] = &b;
+    std::vector<double> weights(2);
+    weights[0] = alpha;
+    weights[1] = 1.0 - alpha;
+    return weightedSum(images, weights);
+}
+
+void Image::resetDirtyGrid(unsigned char value)
+{
+    dirtyTilesX = (width + dirtyTileSize - 1) / dirtyTileSize;
+    int tilesY = (height + dirtyTileSize - 1) / dirtyTileSize;
+    dirtyTiles.assign(static_cast<size_t>(dirtyTilesX) * tilesY, value);
+}
+
+void Image::markDirtyRect(int x0, int y0, int x1, int y1)
+{
+    if (!dirtyTileSize || x0 >= x1 || y0 >= y1) return;
+    int tx1 = (x1 - 1) / dirtyTileSize;
+    int ty1 = (y1 - 1) / dirtyTileSize;
+    for (int ty = y0 / dirtyTileSize; ty <= ty1; ++ty) {
+        unsigned char* r = dirtyTiles.data() + static_cast<size_t>(ty) * dirtyTilesX;
+        std::fill(r + x0 / dirtyTileSize, r + tx1 + 1, 1);
+    }
+}
+
+// Marque tout ; recrée la grille si les dimensions ont changé
+void Image::markAllDirty()
+{
+    if (!dirtyTileSize) return;
+    resetDirtyGrid(1);
+}
+
+void Image::enableDirtyTracking(int tileSize)
+{
+    if (tileSize <= 0) throw std::invalid_argument("Tile size must be positive");
+    dirtyTileSize = tileSize;
+    resetDirtyGrid(0);
+}
+
+void Image::disableDirtyTracking()
+{
+    dirtyTileSize = 0;
+    dirtyTilesX = 0;
+    dirtyTiles.clear();
+    cleanFile.clear();// Les modifications suivantes ne seront plus vues
+}
+
+void Image::clearDirty()
+{
+    if (dirtyTileSize) resetDirtyGrid(0);
+}
+
+size_t Image::dirtyTileCount() const
+{
+    return static_cast<size_t>(std::count(dirtyTiles.begin(), dirtyTiles.end(), 1));
+}
+
+void Image::fillRect(int x, int y, int w, int h, const std::vector<unsigned char>& pix)
+{
+    checkPixelSize(*this, pix);
+    if (w < 0 || h < 0) throw std::invalid_argument("Negative dimension");
+    if (x < 0 || y < 0 || x + w > width || y + h > height)
+        throw std::out_of_range("Rectangle out of range");
+
+    for (int yy = y; yy < y + h; ++yy) {
+        unsigned char* p = pixels.data() + getIndex(x, yy, 0);
+        for (int xx = 0; xx < w; ++xx, p += channels)
+            std::copy(pix.begin(), pix.end(), p);
+    }
+    markDirtyRect(x, y, x + w, y + h);
+}
+
+void Image::saveDirty(const std::string& filepath)
+{
+    // Tuiles propres connues seulement par rapport au fichier de référence
+    if (!dirtyTileSize || filepath != cleanFile) {
+        save(filepath);
+        return;
+    }
+
+    // En-tête du fichier existant : doit correspondre exactement à l'image
+    std::fstream io(filepath, std::ios::in | std::ios::out | std::ios::binary);
+    bool sameFormat = false;
+    if (io) {
+        int w = 0, h = 0, ch = 0;
+        size_t modelSize = 0;
+        io.read(reinterpret_cast<char*>(&w), sizeof(int));
+        io.read(reinterpret_cast<char*>(&h), sizeof(int));
+        io.read(reinterpret_cast<char*>(&ch), sizeof(int));
+        io.read(reinterpret_cast<char*>(&modelSize), sizeof(size_t));
+        if (io && w == width && h == height && ch == channels && modelSize == model.size()) {
+            std::string m(modelSize, '\0');
+            io.read(&m[0], static_cast<std::streamsize>(modelSize));
+            sameFormat = io && m == model;
+        }
+    }
+
+    if (!sameFormat) {
+        io.close();
+        save(filepath);
+        return;
+    }
+
+    // Une écriture par ligne et par suite contiguë de tuiles modifiées
+    std::streamoff dataStart = static_cast<std::streamoff>(3 * sizeof(int) + sizeof(size_t) + model.size());
+    int tilesY = (height + dirtyTileSize - 1) / dirtyTileSize;
+    for (int ty = 0; ty < tilesY; ++ty) {
+        const unsigned char* flags = dirtyTiles.data() + static_cast<size_t>(ty) * dirtyTilesX;
+        int tx = 0;
+        while (tx < dirtyTilesX) {
+            if (!flags[tx]) { ++tx; continue; }
+            int start = tx;
+            while (tx < dirtyTilesX && flags[tx]) ++tx;
+
+            int x0 = start * dirtyTileSize;
+            int x1 = std::min(width, tx * dirtyTileSize);
+            int yEnd = std::min(height, (ty + 1) * dirtyTileSize);
+            for (int y = ty * dirtyTileSize; y < yEnd; ++y) {
+                size_t offset = getIndex(x0, y, 0);
+                io.seekp(dataStart + static_cast<std::streamoff>(offset));
+                io.write(reinterpret_cast<const char*>(pixels.data() + offset),
+                         static_cast<std::streamsize>(static_cast<size_t>(x1 - x0) * channels));
+            }
+        }
+    }
+
+    if (!io) throw std::runtime_error("Error while writing file");
+    clearDirty();
+}
+
 std::ostream& operator<<(std::ostream& os, const Image& img)
 {
     os << "Image(" << img.getWidth() << "x" << img.getHeight()
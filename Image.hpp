@@ -5,6 +5,8 @@
 #include <vector>
 #include <stdexcept>
 #include <ostream>
+#include <cassert>
+#include <limits>
 
 class Image
 {
@@ -15,8 +17,19 @@ private:
     std::string model;
     std::vector<unsigned char> pixels;
 
+    // Suivi des modifications par tuiles carrées (voir enableDirtyTracking)
+    int dirtyTileSize;// 0 : suivi désactivé
+    int dirtyTilesX;
+    mutable std::vector<unsigned char> dirtyTiles;// 1 octet par tuile, 1 = modifiée (remis à 0 par save)
+    mutable std::string cleanFile;// Fichier égal à l'image hors tuiles modifiées (load/save/saveDirty) ; vide : aucun
+
     size_t getIndex(int x, int y, int c) const;
 
+    inline void markDirtyPixel(int x, int y);
+    void markDirtyRect(int x0, int y0, int x1, int y1);// Bornes exclues en x1/y1
+    void markAllDirty();
+    void resetDirtyGrid(unsigned char value);
+
     static unsigned char clampToByte(int value)
     {
         if (value < 0) return 0;
@@ -26,18 +39,53 @@ private:
 
     void checkSameFormat(const Image& other) const;
 
+    // Donne à l'image ces dimensions et ce modèle en gardant la capacité de son buffer (contenu indéfini)
+    void reshape(int w, int h, int ch, const std::string& m);
+    void thresholdTo(int threshold, char op, Image& dst) const;
+
+    // Morphologie binaire : ops = suite de 'e' (érosion) / 'd' (dilatation)
+    Image morphology(int kw, int kh, const char* ops) const;
+
 public:
+    // Composante connexe d'un masque (voir connectedComponents)
+    struct Blob
+    {
+        int area;// nombre de pixels
+        int minX, minY, maxX, maxY;// boîte englobante (bornes incluses)
+        double cx, cy;// centroïde
+    };
+
+    // Vue sur une ligne contiguë de width*channels octets ; indices vérifiés par assert seulement
+    template <typename T>
+    class RowView
+    {
+    private:
+        T* ptr;
+        size_t len;
+
+    public:
+        RowView(T* p, size_t n) : ptr(p), len(n) {}
+
+        inline T* data() const { return ptr; }
+        inline size_t size() const { return len; }
+        inline T* begin() const { return ptr; }
+        inline T* end() const { return ptr + len; }
+        inline T& operator[](size_t i) const { assert(i < len); return ptr[i]; }
+    };
+
     Image();// Défaut : 0×0, "NONE"
     Image(int w, int h, int ch, const std::string& model = "NONE");// Dimensions + modèle
     Image(int w, int h, int ch, const std::string& model, unsigned char fillValue);// Avec remplissage
     Image(int w, int h, int ch, const std::string& model, const std::vector<unsigned char>& buffer);// Copie buffer
 
-    Image(const Image& other);// Constructeur de copie
+    Image(const Image& other);// Constructeur de copie (sans suivi des tuiles modifiées)
     Image& operator=(const Image& other);// Opérateur d'affectation
+    Image(Image&& other) noexcept;// Constructeur de déplacement
+    Image& operator=(Image&& other);// Affectation par déplacement (pas noexcept : peut recréer la grille de suivi)
     ~Image();// Destructeur
 
     void load(const std::string& filepath);// Chargement depuis un fichier
-    void save(const std::string& filepath) const;// Sauvegarde dans un fichier
+    void save(const std::string& filepath) const;// Sauvegarde complète ; efface le suivi des tuiles
 
     inline int getWidth() const { return width; }
     inline int getHeight() const { return height; }
@@ -55,6 +103,7 @@ public:
 
     void resize(int newWidth, int newHeight);
     void clear();
+    void swap(Image& other) noexcept;// Échange complet, sans copie des pixels
 
     unsigned char& at(int x, int y, int c);
     const unsigned char& at(int x, int y, int c) const;
@@ -62,6 +111,20 @@ public:
     inline unsigned char& operator()(int x, int y, int c) { return at(x, y, c); }
     inline const unsigned char& operator()(int x, int y, int c) const { return at(x, y, c); }
 
+    // Accès brut pour les boucles critiques : ligne y vérifiée une fois (assert), pas d'exception
+    // Avec le suivi actif, data()/begin() non const marquent toute l'image, row(y) sa bande de tuiles
+    inline size_t stride() const { return static_cast<size_t>(width) * channels; }// Octets par ligne
+    inline unsigned char* data() { markAllDirty(); return pixels.data(); }
+    inline const unsigned char* data() const { return pixels.data(); }
+    inline RowView<unsigned char> row(int y);
+    inline RowView<const unsigned char> row(int y) const;
+
+    // Itérateurs contigus sur tous les échantillons (ligne après ligne)
+    inline unsigned char* begin() { markAllDirty(); return pixels.data(); }
+    inline unsigned char* end() { return pixels.data() + pixels.size(); }
+    inline const unsigned char* begin() const { return pixels.data(); }
+    inline const unsigned char* end() const { return pixels.data() + pixels.size(); }
+
     // Opérations avec une autre image
     Image  operator+(const Image& other) const;
     Image& operator+=(const Image& other);
@@ -110,6 +173,81 @@ public:
     // Inversion unaire ~
     Image operator~() const;
 
+    // Formes à destination des opérateurs ci-dessus, pour les chaînes d'images (StageFn de Pipeline) :
+    // dst est redimensionné en réutilisant son buffer ; dst peut être *this (ou other)
+    void subtract(const Image& other, Image& dst) const;// dst = *this - other
+    void scale(double s, Image& dst) const;// dst = *this * s
+    void threshold(int threshold, Image& dst) const;// dst = (*this > threshold)
+
+    // Morphologie sur masque 1 canal (pixel != 0 = objet), élément rectangulaire kw×kh
+    // Résultat : image GRAY 0/255
+    Image erode(int kw, int kh) const;
+    Image dilate(int kw, int kh) const;
+    Image opening(int kw, int kh) const;// Érosion puis dilatation
+    Image closing(int kw, int kh) const;// Dilatation puis érosion
+
+    // Composantes connexes d'un masque 1 canal (pixel != 0 = objet), connexité 4 ou 8
+    // Blobs dans l'ordre de balayage ; labels (optionnel) : width*height, 0 = fond, i+1 = blob i
+    std::vector<Blob> connectedComponents(int connectivity = 8, std::vector<int>* labels = nullptr) const;
+
+    // Conversion de modèle couleur : "GRAY", "RGB", "RGBA", "BGR", "YUV" (BT.601 pleine échelle)
+    Image convert(const std::string& targetModel) const;
+    void convert(const std::string& targetModel, Image& dst) const;// Écrit dans dst (buffer réutilisé)
+
+    // Réductions entre deux images de même format et de mêmes dimensions, sans image intermédiaire.
+    // Arrêt anticipé dès que le résultat dépasse limit : la valeur renvoyée est alors partielle (> limit).
+    unsigned long long sumAbsDiff(const Image& other,
+                                  unsigned long long limit = std::numeric_limits<unsigned long long>::max()) const;
+    size_t countChanged(const Image& other, int threshold,
+                        size_t limit = std::numeric_limits<size_t>::max()) const;// Échantillons avec |a - b| > threshold
+    bool anyChanged(const Image& other, int threshold) const;// S'arrête au premier échantillon modifié
+    // Carte GRAY d'un pixel par tuile tileSize×tileSize : 255 si au moins minChanged échantillons modifiés
+    Image changeMap(const Image& other, int tileSize, int threshold, size_t minChanged = 1) const;
+
+    // Noyaux fusionnés : une seule passe en virgule fixe, multithread, une seule image produite.
+    // Images de même format et de mêmes dimensions ; dst peut être l'une des entrées
+    // (le masque alpha de blend passe alors par une image temporaire si a a plusieurs canaux).
+    // Somme pondérée : dst = saturation(Σ weights[i] * images[i]), Σ|weights| <= 256
+    static Image weightedSum(const std::vector<const Image*>& images, const std::vector<double>& weights);
+    static void weightedSum(const std::vector<const Image*>& images, const std::vector<double>& weights, Image& dst);
+    // Mélange : a * α + b * (1 - α), α lu dans un masque 1 canal (0..255) ou constant (0..1)
+    static Image blend(const Image& a, const Image& b, const Image& alpha);
+    static void blend(const Image& a, const Image& b, const Image& alpha, Image& dst);
+    static Image blend(const Image& a, const Image& b, double alpha);
+
+    // Remplissage d'un rectangle (x, y, w, h) avec un pixel ; seules ses tuiles sont marquées
+    void fillRect(int x, int y, int w, int h, const std::vector<unsigned char>& pix);
+
+    // Suivi des tuiles modifiées (at, setPixel, row, fillRect, opérateurs...) pour saveDirty.
+    // Les accès non const marquent même en lecture : le suivi est conservatif.
+    // Les modifications faites sans suivi actif ne sont pas vues : activer le suivi avant de modifier
+    // l'image (après load, ou avant un premier save / saveDirty qui fixe le fichier de référence).
+    void enableDirtyTracking(int tileSize = 64);
+    void disableDirtyTracking();
+    inline bool isDirtyTracking() const { return dirtyTileSize > 0; }
+    void clearDirty();
+    size_t dirtyTileCount() const;
+
+    // Réécrit en place les seules tuiles modifiées si filepath est le fichier du dernier
+    // load/save/saveDirty (même chemin, même format), puis efface le suivi ; sinon sauvegarde complète
+    void saveDirty(const std::string& filepath);
+
+    // Transformations géométriques (copie par tuiles, multithread)
+    Image transpose() const;
+    Image rotate90() const;// Sens horaire
+    Image rotate180() const;
+    Image rotate270() const;// Sens anti-horaire
+    Image flipHorizontal() const;// Miroir gauche/droite
+    Image flipVertical() const;// Miroir haut/bas
+
+    // Variantes en place : sans buffer supplémentaire, sauf transpose/rotate90/rotate270 sur image non carrée
+    void transposeInPlace();
+    void rotate90InPlace();
+    void rotate180InPlace();
+    void rotate270InPlace();
+    void flipHorizontalInPlace();
+    void flipVerticalInPlace();
+
     // Utilitaires internes pour parcourir
     inline bool inBounds(int x, int y, int c) const
     {
@@ -120,7 +258,8 @@ public:
 // Implémentations inline
 
 inline Image::Image()
-    : width(0), height(0), channels(0), model("NONE"), pixels()
+    : width(0), height(0), channels(0), model("NONE"), pixels(),
+      dirtyTileSize(0), dirtyTilesX(0), dirtyTiles(), cleanFile()
 {
 }
 
@@ -129,6 +268,25 @@ inline size_t Image::getIndex(int x, int y, int c) const
     return (static_cast<size_t>(y) * width + x) * channels + c;
 }
 
+inline void Image::markDirtyPixel(int x, int y)
+{
+    if (dirtyTileSize)
+        dirtyTiles[static_cast<size_t>(y / dirtyTileSize) * dirtyTilesX + x / dirtyTileSize] = 1;
+}
+
+inline Image::RowView<unsigned char> Image::row(int y)
+{
+    assert(y >= 0 && y < height);
+    if (dirtyTileSize) markDirtyRect(0, y, width, y + 1);
+    return RowView<unsigned char>(pixels.data() + static_cast<size_t>(y) * stride(), stride());
+}
+
+inline Image::RowView<const unsigned char> Image::row(int y) const
+{
+    assert(y >= 0 && y < height);
+    return RowView<const unsigned char>(pixels.data() + static_cast<size_t>(y) * stride(), stride());
+}
+
 inline void Image::setPixel(int x, int y, int c, unsigned char value)
 {
     at(x, y, c) = value;
@@ -146,6 +304,7 @@ inline void Image::clear()
     channels = 0;
     model = "NONE";
     pixels.clear();
+    markAllDirty();
 }
 
 std::ostream& operator<<(std::ostream& os, const Image& img);
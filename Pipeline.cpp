@@ -0,0 +1,294 @@
+#include "Pipeline.hpp"
+#include <algorithm>
+
+// Worker courant (thread_local) : submit depuis un worker empile dans sa propre file
+static thread_local const WorkStealingPool* currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+    : pending(0), stopping(false), nextWorker(0)
+{
+    if (threadCount <= 0) threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    if (threadCount <= 0) threadCount = 1;
+
+    for (int i = 0; i < threadCount; ++i) workers.emplace_back(new Worker());
+    for (int i = 0; i < threadCount; ++i) threads.emplace_back(&WorkStealingPool::run, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) t.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> task)
+{
+    int target = (currentPool == this) ? currentWorker
+                                       : static_cast<int>(nextWorker++ % workers.size());
+    // Compté avant d'être visible : un worker qui la vole ne peut pas décrémenter pending avant nous
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        ++pending;
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers[target]->mutex);
+        workers[target]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+bool WorkStealingPool::tryTake(int self, std::function<void()>& task)
+{
+    {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    int n = static_cast<int>(workers.size());
+    for (int k = 1; k < n; ++k) {
+        Worker& victim = *workers[(self + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(int self)
+{
+    currentPool = this;
+    currentWorker = self;
+
+    for (;;) {
+        std::function<void()> task;
+        if (tryTake(self, task)) {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                --pending;
+            }
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping && pending == 0) return;
+        wake.wait(lock, [this] { return pending > 0 || stopping; });
+        if (stopping && pending == 0) return;
+    }
+}
+
+Pipeline::Pipeline(size_t queueCapacity, int threadCount)
+    : capacity(queueCapacity), closed(false), started(false), stopping(false), pool(threadCount)
+{
+    if (queueCapacity == 0) throw std::invalid_argument("Queue capacity must be positive");
+}
+
+Pipeline::~Pipeline()
+{
+    // Les images non commencées sont abandonnées ; on attend celles en cours de calcul
+    std::unique_lock<std::mutex> lock(mutex);
+    closed = true;
+    stopping = true;
+    for (Stage& s : stages)
+        if (!s.running) s.input.clear();
+    changed.wait(lock, [this] {
+        for (const Stage& s : stages)
+            if (s.running) return false;
+        return true;
+    });
+}
+
+void Pipeline::addStage(const std::string& name, StageFn fn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (started) throw std::logic_error("Cannot add a stage to a running pipeline");
+
+    Stage stage;
+    stage.name = name;
+    stage.fn = fn;
+    stage.running = false;
+    stage.frames = 0;
+    stage.totalMs = 0.0;
+    stage.maxMs = 0.0;
+    stages.push_back(std::move(stage));
+}
+
+void Pipeline::addStage(const std::string& name, MapFn fn)
+{
+    addStage(name, StageFn([fn](const Image& in, Image& out) { out = fn(in); }));
+}
+
+// Place disponible dans la file qui suit l'étape i
+bool Pipeline::hasSpaceAfter(size_t i) const
+{
+    if (i + 1 < stages.size()) return stages[i + 1].input.size() < capacity;
+    return output.size() < capacity;
+}
+
+bool Pipeline::idle() const
+{
+    for (const Stage& s : stages)
+        if (s.running || !s.input.empty()) return false;
+    return true;
+}
+
+// Appelé sous verrou : lance l'étape i si elle a une image et de la place en aval
+void Pipeline::schedule(size_t i)
+{
+    Stage& s = stages[i];
+    if (stopping || s.running || s.input.empty() || !hasSpaceAfter(i)) return;
+    s.running = true;
+    pool.submit([this, i] { runStage(i); });
+}
+
+void Pipeline::runStage(size_t i)
+{
+    const StageFn& fn = stages[i].fn;// stages n'est plus modifié une fois démarré
+    Image in, out;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stage& s = stages[i];
+        in = std::move(s.input.front());
+        s.input.pop_front();
+        if (!s.freeBuffers.empty()) {
+            out = std::move(s.freeBuffers.back());
+            s.freeBuffers.pop_back();
+        }
+        if (i > 0) schedule(i - 1);// place libérée dans notre file d'entrée
+    }
+    changed.notify_all();
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    std::exception_ptr failure;
+    try {
+        fn(in, out);
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stage& s = stages[i];
+        s.running = false;
+        s.frames++;
+        s.totalMs += ms;
+        s.maxMs = std::max(s.maxMs, ms);
+
+        // L'image d'entrée redevient un buffer libre pour son producteur
+        if (i == 0) inputBuffers.push_back(std::move(in));
+        else stages[i - 1].freeBuffers.push_back(std::move(in));
+
+        if (failure) {
+            if (!error) error = std::move(failure);
+            s.freeBuffers.push_back(std::move(out));
+        } else if (i + 1 < stages.size()) {
+            stages[i + 1].input.push_back(std::move(out));
+            schedule(i + 1);
+        } else {
+            output.push_back(std::move(out));
+        }
+        schedule(i);
+    }
+    changed.notify_all();
+}
+
+void Pipeline::push(const Image& frame)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (stages.empty()) throw std::logic_error("Pipeline has no stage");
+    if (closed) throw std::logic_error("Pipeline is closed");
+
+    changed.wait(lock, [this] { return stages[0].input.size() < capacity; });
+    if (!started) {
+        started = true;
+        startTime = std::chrono::steady_clock::now();
+    }
+
+    Image buffer;
+    if (!inputBuffers.empty()) {
+        buffer = std::move(inputBuffers.back());
+        inputBuffers.pop_back();
+    }
+    buffer = frame;// réutilise la capacité du buffer recyclé
+    stages[0].input.push_back(std::move(buffer));
+    schedule(0);
+}
+
+bool Pipeline::pop(Image& frame)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return !output.empty() || error || (closed && idle()); });
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+    if (output.empty()) return false;
+
+    // L'ancien contenu de frame sert de buffer pour la dernière étape
+    frame.swap(output.front());
+    stages.back().freeBuffers.push_back(std::move(output.front()));
+    output.pop_front();
+    schedule(stages.size() - 1);
+    return true;
+}
+
+bool Pipeline::tryPop(Image& frame)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+    if (output.empty()) return false;
+
+    frame.swap(output.front());
+    stages.back().freeBuffers.push_back(std::move(output.front()));
+    output.pop_front();
+    schedule(stages.size() - 1);
+    return true;
+}
+
+void Pipeline::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    changed.notify_all();
+}
+
+std::vector<Pipeline::StageStats> Pipeline::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    double elapsedMs = started
+        ? std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count()
+        : 0.0;
+
+    std::vector<StageStats> result;
+    for (const Stage& s : stages) {
+        StageStats st;
+        st.name = s.name;
+        st.frames = s.frames;
+        st.meanMs = s.frames ? s.totalMs / s.frames : 0.0;
+        st.maxMs = s.maxMs;
+        st.fps = elapsedMs > 0.0 ? s.frames * 1000.0 / elapsedMs : 0.0;
+        st.utilization = elapsedMs > 0.0 ? std::min(1.0, s.totalMs / elapsedMs) : 0.0;
+        result.push_back(st);
+    }
+    return result;
+}
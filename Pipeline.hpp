@@ -0,0 +1,127 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "Image.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pool de threads à vol de tâches : chaque worker a sa propre file,
+// dépile ses tâches par la fin et vole les autres par le début
+class WorkStealingPool
+{
+private:
+    struct Worker
+    {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    size_t pending;// tâches en file (protégé par sleepMutex)
+    bool stopping;
+    std::atomic<unsigned> nextWorker;
+
+    bool tryTake(int self, std::function<void()>& task);
+    void run(int self);
+
+public:
+    explicit WorkStealingPool(int threadCount = 0);// 0 : un thread par cœur
+    ~WorkStealingPool();// Termine les tâches en file puis arrête les threads
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(std::function<void()> task);
+    inline int size() const { return static_cast<int>(workers.size()); }
+};
+
+// Chaîne d'opérations appliquée à un flux d'images.
+// Les étapes sont déclarées une fois puis alimentées image par image ; chaque étape
+// traite ses images dans l'ordre, mais des étapes différentes travaillent en même temps
+// sur des images différentes. Files bornées entre étapes et buffers de sortie recyclés.
+class Pipeline
+{
+public:
+    typedef std::function<void(const Image& in, Image& out)> StageFn;// Écrit dans out (buffer réutilisé)
+    // Renvoie une nouvelle image. Limite : l'adaptateur fait out = fn(in), le buffer recyclé
+    // est remplacé par l'image renvoyée, donc une allocation par image. Pour réutiliser les
+    // buffers, écrire un StageFn appelant les formes à destination : subtract, scale, threshold,
+    // convert(model, out), weightedSum(images, weights, out), blend(a, b, alpha, out)
+    typedef std::function<Image(const Image& in)> MapFn;
+
+    struct StageStats
+    {
+        std::string name;
+        size_t frames;// images traitées
+        double meanMs;// latence moyenne d'une image dans l'étape
+        double maxMs;// latence maximale
+        double fps;// débit depuis la première image
+        double utilization;// fraction du temps passée à calculer (0..1)
+    };
+
+private:
+    struct Stage
+    {
+        std::string name;
+        StageFn fn;
+        std::deque<Image> input;// images en attente pour cette étape
+        std::vector<Image> freeBuffers;// buffers de sortie recyclés
+        bool running;
+        size_t frames;
+        double totalMs;
+        double maxMs;
+    };
+
+    size_t capacity;
+    std::vector<Stage> stages;
+    std::deque<Image> output;
+    std::vector<Image> inputBuffers;// copies recyclées des images poussées
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    bool closed;
+    bool started;
+    bool stopping;// destruction en cours : plus aucune étape lancée
+    std::chrono::steady_clock::time_point startTime;
+    std::exception_ptr error;
+
+    bool hasSpaceAfter(size_t i) const;
+    bool idle() const;
+    void schedule(size_t i);
+    void runStage(size_t i);
+
+    WorkStealingPool pool;// Dernier membre : détruit (threads rejoints) en premier
+
+public:
+    explicit Pipeline(size_t queueCapacity = 4, int threadCount = 0);
+    ~Pipeline();// Attend la fin des images en cours
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    void addStage(const std::string& name, StageFn fn);
+    void addStage(const std::string& name, MapFn fn);
+
+    void push(const Image& frame);// Bloque tant que la première file est pleine
+    bool pop(Image& frame);// Bloque jusqu'à la prochaine image ; false si fermé et vide
+    bool tryPop(Image& frame);// Sans attente
+    void close();// Plus d'entrées : pop renvoie false une fois tout traité
+
+    std::vector<StageStats> stats() const;
+};
+
+#endif // PIPELINE_HPP
@@ -1,9 +1,10 @@
 #include <iostream>
 #include <vector>
 #include "Image.hpp"
+#include "Pipeline.hpp"
 
 // .\compile_and_run.ps1
-// g++ -std=c++17 -Wall -Wextra -O2 Image.cpp main.cpp -o test_image.exe
+// g++ -std=c++17 -Wall -Wextra -O2 Image.cpp Pipeline.cpp main.cpp -o test_image.exe
 // .\test_image.exe
 
 // Petit helper pour afficher un pixel (tous les canaux)
@@ -131,6 +132,32 @@ int main()
         std::cout << "\n";
 
 
+        std::cout << "REDUCTIONS ENTRE DEUX IMAGES (sans image intermediaire)\n";
+        Image frameA(4, 3, 3, "RGB", 10);
+        Image frameB(frameA);
+        frameB(2, 1, 0) = 60;
+        std::cout << "[sad] frameA.sumAbsDiff(frameB) = " << frameA.sumAbsDiff(frameB) << "\n";
+        std::cout << "[count] frameA.countChanged(frameB, 20) = " << frameA.countChanged(frameB, 20) << "\n";
+        std::cout << "[any] frameA.anyChanged(frameB, 20) = " << frameA.anyChanged(frameB, 20) << "\n";
+        std::cout << "[map] frameA.changeMap(frameB, 2, 20) = " << frameA.changeMap(frameB, 2, 20)
+                  << ", tuile (1,0) = " << (int)frameA.changeMap(frameB, 2, 20).getPixel(1, 0, 0) << "\n\n";
+
+
+        std::cout << "MELANGES FUSIONNES (une passe, une seule image)\n";
+        Image blendAlpha(4, 3, 1, "GRAY", 64);
+        Image blended = Image::blend(img1, brighter, blendAlpha);
+        std::cout << "[blended] Image::blend(img1, brighter, masque 64)\n";
+        printPixel(blended, 0, 0, "   blended (0,0)");
+        std::vector<const Image*> inputs(3);
+        inputs[0] = &img1; inputs[1] = &brighter; inputs[2] = &mult;
+        std::vector<double> weights(3);
+        weights[0] = 0.5; weights[1] = 0.25; weights[2] = 0.25;
+        Image mix = Image::weightedSum(inputs, weights);
+        std::cout << "[mix] 0.5*img1 + 0.25*brighter + 0.25*mult\n";
+        printPixel(mix, 0, 0, "   mix (0,0)");
+        std::cout << "\n";
+
+
         std::cout << "TEST D'EXCEPTION DE FORMAT (RGB vs GRAY)\n";
         try {
             Image gray(4, 3, 1, "GRAY", 100);
@@ -141,12 +168,111 @@ int main()
             std::cout << "   Exception attendue : " << e.what() << "\n\n";
         }
 
+        std::cout << "ACCES PAR LIGNE (row / data / stride)\n";
+        Image ramp(4, 2, 1, "GRAY", 0);
+        for (int y = 0; y < ramp.getHeight(); ++y) {
+            Image::RowView<unsigned char> r = ramp.row(y);
+            for (size_t i = 0; i < r.size(); ++i) r[i] = static_cast<unsigned char>(10 * (y * r.size() + i));
+        }
+        int total = 0;
+        for (unsigned char v : ramp) total += v;
+        std::cout << "[ramp] stride = " << ramp.stride() << ", somme des echantillons = " << total << "\n\n";
+
+        std::cout << "MORPHOLOGIE BINAIRE (masque GRAY)\n";
+        Image mask(8, 8, 1, "GRAY", 0);
+        for (int y = 2; y < 6; ++y)
+            for (int x = 2; x < 6; ++x) mask(x, y, 0) = 255;
+        mask(0, 0, 0) = 255; // bruit isole
+        Image opened = mask.opening(3, 3);
+        std::cout << "[opened] mask.opening(3, 3)\n";
+        std::cout << "   bruit (0,0) = " << (int)opened.getPixel(0, 0, 0)
+                  << ", centre (3,3) = " << (int)opened.getPixel(3, 3, 0) << "\n";
+        Image dilated = mask.dilate(3, 3);
+        std::cout << "[dilated] mask.dilate(3, 3) : (1,1) = " << (int)dilated.getPixel(1, 1, 0) << "\n\n";
+
+        std::cout << "COMPOSANTES CONNEXES\n";
+        std::vector<Image::Blob> blobs = mask.connectedComponents(8);
+        std::cout << "[blobs] mask.connectedComponents(8) : " << blobs.size() << " composantes\n";
+        for (size_t i = 0; i < blobs.size(); ++i) {
+            std::cout << "   blob " << i << " : aire = " << blobs[i].area
+                      << ", boite = (" << blobs[i].minX << "," << blobs[i].minY << ")-("
+                      << blobs[i].maxX << "," << blobs[i].maxY << ")"
+                      << ", centre = (" << blobs[i].cx << "," << blobs[i].cy << ")\n";
+        }
+        std::cout << "\n";
+
+        std::cout << "CONVERSION DE MODELE COULEUR\n";
+        Image grayImg = img1.convert("GRAY");
+        Image yuvImg = img1.convert("YUV");
+        std::cout << "[grayImg] img1.convert(\"GRAY\") = " << grayImg << "\n";
+        printPixel(img1,    0, 0, "   avant  (img1)");
+        printPixel(grayImg, 0, 0, "   apres  (grayImg)");
+        printPixel(yuvImg,  0, 0, "   apres  (yuvImg)");
+        std::cout << "\n";
+
+        std::cout << "TRANSFORMATIONS GEOMETRIQUES\n";
+        Image rotated = img1.rotate90();
+        std::cout << "[rotated] img1.rotate90() = " << rotated << "\n";
+        printPixel(img1,    0, 0, "   avant  (img1)");
+        printPixel(rotated, 2, 0, "   apres  (rotated)");
+        Image flipped(img1);
+        flipped.flipHorizontalInPlace();
+        printPixel(flipped, 3, 0, "   apres  (flipHorizontalInPlace)");
+        std::cout << "\n";
+
+        std::cout << "PIPELINE SUR UN FLUX D'IMAGES\n";
+        {
+            Image background(4, 3, 1, "GRAY", 20);
+            Pipeline pipeline(2);
+            // Formes à destination : chaque étape écrit dans son buffer recyclé, sans allocation par image
+            pipeline.addStage("soustraction", [&](const Image& in, Image& out) { in.subtract(background, out); });
+            pipeline.addStage("echelle", [](const Image& in, Image& out) { in.scale(2.0, out); });
+            pipeline.addStage("seuil", [](const Image& in, Image& out) { in.threshold(100, out); });
+
+            const int frameCount = 5;
+            std::thread producer([&]() {
+                for (int f = 0; f < frameCount; ++f)
+                    pipeline.push(Image(4, 3, 1, "GRAY", static_cast<unsigned char>(40 + 20 * f)));
+                pipeline.close();
+            });
+
+            Image frameOut;
+            int f = 0;
+            while (pipeline.pop(frameOut))
+                std::cout << "   image " << f++ << " : (0,0) = " << (int)frameOut.getPixel(0, 0, 0) << "\n";
+            producer.join();
+
+            std::vector<Pipeline::StageStats> stats = pipeline.stats();
+            for (size_t i = 0; i < stats.size(); ++i)
+                std::cout << "   etape " << stats[i].name << " : " << stats[i].frames << " images\n";
+        }
+        std::cout << "\n";
+
         std::cout << "SAUVEGARDE / CHARGEMENT\n";
         img1.save("test.imgbin");
         Image imgLoaded;
         imgLoaded.load("test.imgbin");
         std::cout << "   imgLoaded = " << imgLoaded << "\n";
 
+        imgLoaded.enableDirtyTracking(2);
+        imgLoaded.setPixel(3, 2, 0, 200);
+        std::vector<unsigned char> blue(3);
+        blue[0] = 0; blue[1] = 0; blue[2] = 255;
+        imgLoaded.fillRect(0, 0, 1, 1, blue);
+        std::cout << "   tuiles modifiees = " << imgLoaded.dirtyTileCount() << "\n";
+        imgLoaded.saveDirty("test.imgbin");
+        Image imgDelta;
+        imgDelta.load("test.imgbin");
+        printPixel(imgDelta, 3, 2, "   apres saveDirty (imgDelta)");
+
+        // Image dérivée : copie non suivie, saveDirty réécrit tout le fichier
+        Image imgDerived = imgLoaded + 50;
+        std::cout << "   imgDerived suivie = " << imgDerived.isDirtyTracking() << "\n";
+        imgDerived.saveDirty("test.imgbin");
+        imgDelta.load("test.imgbin");
+        printPixel(imgDelta, 3, 2, "   apres saveDirty (imgDerived)");
+        img1.save("test.imgbin");
+
         std::cout << "FIN DES TESTS\n";
 
     } catch (const std::exception& e) {